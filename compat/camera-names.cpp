@@ -13,18 +13,28 @@
 
 #ifdef __APPLE__
 #   include <QCameraInfo>
+#   include "timer.hpp"
 #endif
 
 #ifdef __linux__
 #   include <fcntl.h>
 #   include <sys/ioctl.h>
+#   include <sys/inotify.h>
 #   include <linux/videodev2.h>
 #   include <cerrno>
 #   include <cstring>
 #endif
 
+#include <QMutex>
 #include <QDebug>
 
+#ifdef _WIN32
+#   include <atomic>
+#   include <QAbstractNativeEventFilter>
+#   include <QCoreApplication>
+#   include <QThread>
+#endif
+
 int camera_name_to_index(const QString &name)
 {
     auto list = get_camera_names();
@@ -41,9 +51,9 @@ int camera_name_to_index(const QString &name)
     return -1;
 }
 
-std::vector<std::tuple<QString, int>> get_camera_names()
+static std::vector<camera_device> enum_cameras()
 {
-    std::vector<std::tuple<QString, int>> ret;
+    std::vector<camera_device> ret;
 #ifdef _WIN32
     // Create the System Device Enumerator.
     HRESULT hr;
@@ -76,7 +86,11 @@ std::vector<std::tuple<QString, int>> get_camera_names()
                 {
                     // Display the name in your UI somehow.
                     QString str((QChar*)var.bstrVal, int(std::wcslen(var.bstrVal)));
-                    ret.push_back({ str, ret.size() });
+                    VariantClear(&var);
+                    QString path;
+                    if (SUCCEEDED(pPropBag->Read(L"DevicePath", &var, nullptr)))
+                        path = QString((QChar*)var.bstrVal, int(std::wcslen(var.bstrVal)));
+                    ret.push_back({ str, path, (int)ret.size() });
                 }
                 VariantClear(&var);
                 pPropBag->Release();
@@ -92,12 +106,12 @@ std::vector<std::tuple<QString, int>> get_camera_names()
 #endif
 
 #ifdef __linux__
-    for (int i = 0; i < 16; i++) {
+    for (int i = 0; i < 64; i++) {
         char buf[32];
         snprintf(buf, sizeof(buf), "/dev/video%d", i);
 
         if (access(buf, R_OK | W_OK) == 0) {
-            int fd = open(buf, O_RDONLY);
+            int fd = open(buf, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
             if (fd == -1)
                 continue;
             struct v4l2_capability video_cap;
@@ -107,7 +121,9 @@ std::vector<std::tuple<QString, int>> get_camera_names()
                 close(fd);
                 continue;
             }
-            ret.push_back({ QString((const char*)video_cap.card), i});
+            unsigned caps = video_cap.capabilities & V4L2_CAP_DEVICE_CAPS ? video_cap.device_caps : video_cap.capabilities;
+            bool can_capture = (caps & V4L2_CAP_VIDEO_CAPTURE) && (caps & V4L2_CAP_STREAMING);
+            ret.push_back({ QString((const char*)video_cap.card), QString((const char*)video_cap.bus_info), i, can_capture });
             close(fd);
         }
     }
@@ -115,8 +131,142 @@ std::vector<std::tuple<QString, int>> get_camera_names()
 #ifdef __APPLE__
     QList<QCameraInfo> cameras = QCameraInfo::availableCameras();
     for (const QCameraInfo &cameraInfo : cameras)
-        ret.push_back({ cameraInfo.description(), ret.size() });
+        ret.push_back({ cameraInfo.description(), cameraInfo.deviceName(), (int)ret.size() });
+#endif
+
+    return ret;
+}
+
+#ifdef __linux__
+// Device nodes appearing, going away or getting their permissions fixed
+// up by udev all show up as inotify events on /dev.
+struct dev_watch final
+{
+    int fd = -1;
+
+    dev_watch()
+    {
+        fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (fd == -1)
+            return;
+        if (inotify_add_watch(fd, "/dev", IN_CREATE | IN_DELETE | IN_ATTRIB | IN_MOVED_FROM | IN_MOVED_TO) == -1)
+        {
+            qDebug() << "camera: can't watch /dev" << errno;
+            close(fd);
+            fd = -1;
+        }
+    }
+
+    ~dev_watch()
+    {
+        if (fd != -1)
+            close(fd);
+    }
+
+    // whether any video node changed since the last call
+    bool changed()
+    {
+        if (fd == -1)
+            return true;
+
+        alignas(inotify_event) char buf[4096];
+        bool ret = false;
+        ssize_t len;
+
+        while ((len = read(fd, buf, sizeof(buf))) > 0)
+        {
+            for (ssize_t pos = 0; pos < len; )
+            {
+                const auto& ev = *(const inotify_event*)(buf + pos);
+                if (ev.mask & IN_Q_OVERFLOW || (ev.len && !std::strncmp(ev.name, "video", 5)))
+                    ret = true;
+                pos += (ssize_t)(sizeof(inotify_event) + ev.len);
+            }
+        }
+
+        return ret;
+    }
+};
+#endif
+
+#ifdef _WIN32
+// DirectShow enumeration is slow. Cameras coming and going are broadcast
+// to all top-level windows as WM_DEVICECHANGE.
+struct dev_watch final : QAbstractNativeEventFilter
+{
+    std::atomic<bool> dirty { true }, installed { false };
+
+    bool nativeEventFilter(const QByteArray&, void* message, long*) override
+    {
+        if (static_cast<const MSG*>(message)->message == WM_DEVICECHANGE)
+            dirty = true;
+        return false;
+    }
+
+    bool changed()
+    {
+        QCoreApplication* app = QCoreApplication::instance();
+
+        // no event loop to tell us, don't cache
+        if (!app)
+            return true;
+
+        if (!installed.exchange(true))
+        {
+            if (QThread::currentThread() == app->thread())
+                app->installNativeEventFilter(this);
+            else
+                QMetaObject::invokeMethod(app, [this, app] { app->installNativeEventFilter(this); }, Qt::QueuedConnection);
+        }
+
+        return dirty.exchange(false);
+    }
+};
+#elif defined __APPLE__
+// no change notifications without an AVFoundation observer, re-enumerate
+// at most every few seconds
+struct dev_watch final
+{
+    static constexpr double max_age_ms = 2000;
+    Timer t;
+
+    bool changed()
+    {
+        if (t.elapsed_ms() < max_age_ms)
+            return false;
+        t.start();
+        return true;
+    }
+};
+#elif !defined __linux__
+struct dev_watch final
+{
+    bool changed() { return false; }
+};
 #endif
 
+std::vector<camera_device> get_camera_devices()
+{
+    static QMutex mtx;
+    static dev_watch watch;
+    static std::vector<camera_device> cache;
+    static bool valid = false;
+
+    QMutexLocker l(&mtx);
+
+    if (watch.changed() || !valid)
+    {
+        cache = enum_cameras();
+        valid = true;
+    }
+
+    return cache;
+}
+
+std::vector<std::tuple<QString, int>> get_camera_names()
+{
+    std::vector<std::tuple<QString, int>> ret;
+    for (const camera_device& dev : get_camera_devices())
+        ret.push_back({ dev.name, dev.index });
     return ret;
 }
@@ -14,6 +14,17 @@
 
 #include "export.hpp"
 
+struct camera_device final
+{
+    QString name;
+    // survives reboots and replugging into the same port, unlike the index
+    QString bus_path;
+    int index;
+    // Linux: a V4L2 node that can stream video, not e.g. a UVC metadata node
+    bool can_capture = true;
+};
+
+OTR_COMPAT_EXPORT std::vector<camera_device> get_camera_devices();
 OTR_COMPAT_EXPORT std::vector<std::tuple<QString, int>> get_camera_names();
 OTR_COMPAT_EXPORT int camera_name_to_index(const QString &name);
 
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <atomic>
+
+// Latest-value slot of N doubles for exactly one writer thread and any number of readers.
+// The writer never waits. Readers retry their copy if a write raced with it,
+// so they always see all N values from the same store().
+
+template<unsigned N>
+class seqlock_slot final
+{
+    std::atomic<unsigned> seq { 0 }; // odd while a store() is in progress
+    std::atomic<double> values[N] {};
+
+public:
+    // writer only
+    void store(const double* src)
+    {
+        const unsigned s = seq.load(std::memory_order_relaxed);
+        seq.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        for (unsigned i = 0; i < N; i++)
+            values[i].store(src[i], std::memory_order_relaxed);
+
+        seq.store(s + 2, std::memory_order_release);
+    }
+
+    void load(double* dst) const
+    {
+        unsigned before, after;
+        do
+        {
+            before = seq.load(std::memory_order_acquire);
+
+            for (unsigned i = 0; i < N; i++)
+                dst[i] = values[i].load(std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = seq.load(std::memory_order_relaxed);
+        }
+        while ((before & 1) || before != after);
+    }
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+
+// Bounded lock-free queue for exactly one producer and one consumer thread.
+// Elements are copied in and out, so keep them small and trivially copyable.
+
+template<typename t, unsigned N>
+class spsc_queue final
+{
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "queue size must be a power of two");
+
+    std::array<t, N> buf {};
+
+    // both only ever increase, wrapping around at UINT_MAX
+    alignas(64) std::atomic<unsigned> head { 0 }; // written by the producer
+    alignas(64) std::atomic<unsigned> tail { 0 }; // written by the consumer
+
+public:
+    // producer only, returns false if the queue is full
+    bool push(const t& value)
+    {
+        const unsigned h = head.load(std::memory_order_relaxed);
+
+        if (h - tail.load(std::memory_order_acquire) == N)
+            return false;
+
+        buf[h % N] = value;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer only, returns false if the queue is empty
+    bool pop(t& value)
+    {
+        const unsigned tl = tail.load(std::memory_order_relaxed);
+
+        if (head.load(std::memory_order_acquire) == tl)
+            return false;
+
+        value = buf[tl % N];
+        tail.store(tl + 1, std::memory_order_release);
+        return true;
+    }
+};
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+
+// Wire formats sent by the UDP protocol and accepted by the UDP tracker,
+// both in host byte order.
+// The legacy format is six bare doubles: X, Y, Z, yaw, pitch, roll.
+// The extended format prepends a sequence number and the sender's clock
+// so the receiver can count lost and reordered packets and measure latency.
+
+namespace udp_packet {
+
+struct extended final
+{
+    static constexpr uint32_t magic_value = 0x5852544f; // "OTRX"
+
+    uint32_t magic;
+    uint32_t sequence;      // incremented by one per packet, wraps around
+    uint64_t timestamp_us;  // microseconds since the Unix epoch on the sender
+    double pose[6];
+};
+
+static_assert(sizeof(extended) == 64);
+
+} // ns udp_packet
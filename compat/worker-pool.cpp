@@ -0,0 +1,87 @@
+#include "worker-pool.hpp"
+#include "thread-name.hpp"
+
+worker_pool::worker_pool(unsigned nthreads, const QString& name)
+{
+    if (nthreads > 1)
+        threads.reserve(nthreads - 1);
+
+    for (unsigned i = 1; i < nthreads; i++)
+        threads.emplace_back([this, name = QStringLiteral("%1/%2").arg(name).arg(i)] {
+            worker_loop(name);
+        });
+}
+
+worker_pool::~worker_pool()
+{
+    {
+        std::lock_guard l(mtx);
+        quit = true;
+    }
+    cv_work.notify_all();
+
+    for (std::thread& t : threads)
+        t.join();
+}
+
+void worker_pool::run_jobs(std::unique_lock<std::mutex>& l)
+{
+    while (next_job < njobs)
+    {
+        const unsigned k = next_job++;
+        const job& f = *fun;
+
+        l.unlock();
+        f(k);
+        l.lock();
+
+        if (--pending == 0)
+            cv_done.notify_all();
+    }
+}
+
+void worker_pool::worker_loop(const QString& name)
+{
+    portable::set_curthread_name(name);
+
+    unsigned seen = 0;
+    std::unique_lock l(mtx);
+
+    for (;;)
+    {
+        cv_work.wait(l, [&] { return quit || generation != seen; });
+
+        if (quit)
+            break;
+
+        seen = generation;
+        run_jobs(l);
+    }
+}
+
+void worker_pool::run(unsigned n, const job& fun_)
+{
+    if (threads.empty())
+    {
+        for (unsigned k = 0; k < n; k++)
+            fun_(k);
+        return;
+    }
+
+    if (n == 0)
+        return;
+
+    std::unique_lock l(mtx);
+
+    fun = &fun_;
+    njobs = n; next_job = 0; pending = n;
+    generation++;
+
+    cv_work.notify_all();
+
+    run_jobs(l);
+    cv_done.wait(l, [this] { return pending == 0; });
+
+    fun = nullptr;
+    njobs = 0;
+}
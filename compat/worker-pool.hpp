@@ -0,0 +1,45 @@
+#pragma once
+
+#include "export.hpp"
+
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+
+#include <QString>
+
+// Fixed-size pool for data-parallel work on the calling thread's behalf.
+// Not reentrant, only one thread may call run() at a time.
+
+class OTR_COMPAT_EXPORT worker_pool final
+{
+public:
+    using job = std::function<void(unsigned)>;
+
+    // `nthreads' includes the calling thread, 1 means no worker threads
+    worker_pool(unsigned nthreads, const QString& name);
+    ~worker_pool();
+
+    worker_pool(const worker_pool&) = delete;
+    worker_pool& operator=(const worker_pool&) = delete;
+
+    unsigned size() const { return unsigned(threads.size()) + 1; }
+
+    // calls fun(0) ... fun(n-1) on the pool and the calling thread,
+    // returns once all of them finished
+    void run(unsigned n, const job& fun);
+
+private:
+    void worker_loop(const QString& name);
+    void run_jobs(std::unique_lock<std::mutex>& l);
+
+    std::vector<std::thread> threads;
+    std::mutex mtx;
+    std::condition_variable cv_work, cv_done;
+
+    const job* fun = nullptr;
+    unsigned njobs = 0, next_job = 0, pending = 0, generation = 0;
+    bool quit = false;
+};
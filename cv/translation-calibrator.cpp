@@ -55,12 +55,10 @@ using cv_out_vec = TranslationCalibrator::cv_nsample_vec;
 using cv_in_vec = TranslationCalibrator::cv_cal_vec;
 using tt = TranslationCalibrator::tt;
 
-tt TranslationCalibrator::get_estimate()
+TranslationCalibrator::cv_nsample_vec TranslationCalibrator::get_sample_count() const
 {
-    cv::Vec6f x = P.inv() * y;
-
     vec_i const* in[num_nsample_axis] = { &used_yaw_poses, &used_pitch_poses, };
-    unsigned nsamples[num_cal_axis] {};
+    cv_nsample_vec nsamples;
 
     for (unsigned k = 0; k < num_nsample_axis; k++)
     {
@@ -70,13 +68,22 @@ tt TranslationCalibrator::get_estimate()
                 nsamples[k]++;
     }
 
-    qDebug() << "samples total" << nsamples
+    return nsamples;
+}
+
+tt TranslationCalibrator::get_estimate()
+{
+    cv::Vec6f x = P.inv() * y;
+
+    const cv_nsample_vec nsamples = get_sample_count();
+
+    qDebug() << "samples total" << nsamples[0] + nsamples[1]
              << "yaw" << nsamples[0]
              << "pitch" << nsamples[1];
 
     return {
         { -x[0], -x[1], -x[2] },
-        { nsamples[0], nsamples[1] },
+        nsamples,
     };
 }
 
@@ -51,6 +51,9 @@ public:
     // get the current estimate for t_MH
     tt get_estimate();
 
+    // number of distinct yaw and pitch poses seen so far
+    cv_nsample_vec get_sample_count() const;
+
     static constexpr double yaw_spacing_in_degrees = 2;
     static constexpr double pitch_spacing_in_degrees = 1.5;
 };
@@ -12,34 +12,10 @@ void cv_video_widget::update_image(const cv::Mat& frame)
     if (W < 1 || H < 1 || frame.rows < 1 || frame.cols < 1)
         return;
 
-    cv::Mat const* __restrict scaled = nullptr;
-
-    if (frame3.cols != W || frame3.rows != H)
-    {
-        frame3 = cv::Mat(H, W, frame.type());
-        frame2 = cv::Mat(H, W, CV_8UC4);
-
-        if (!frame2.isContinuous() || !frame3.isContinuous())
-            std::abort();
-    }
-
-    if (frame.cols != W || frame.rows != H)
-    {
-        cv::resize(frame, frame3, { W, H }, 0, 0, cv::INTER_NEAREST);
-        scaled = &frame3;
-    }
-    else if (!frame.isContinuous())
-    {
-        frame.copyTo(frame3);
-        scaled = &frame3;
-    }
-    else
-        scaled = &frame;
-
     int color_cvt = cv::COLOR_COLORCVT_MAX;
     constexpr int nchannels = 4;
 
-    switch (scaled->channels())
+    switch (frame.channels())
     {
     case 1:
         color_cvt = cv::COLOR_GRAY2BGRA;
@@ -54,19 +30,24 @@ void cv_video_widget::update_image(const cv::Mat& frame)
         break;
     }
 
-    cv::Mat const* color;
+    // a header over the widget's back buffer, nothing below reallocates it
+    cv::Mat dest(H, W, CV_8UC(nchannels),
+                 back_buffer(W, H, W * nchannels, QImage::Format_ARGB32));
 
-    if (color_cvt != cv::COLOR_COLORCVT_MAX)
+    cv::Mat const* scaled = &frame;
+
+    if (frame.cols != W || frame.rows != H)
     {
-        cv::cvtColor(*scaled, frame2, color_cvt);
-        color = &frame2;
+        // scale first, the preview is usually smaller than the frame
+        cv::Mat& out = color_cvt == cv::COLOR_COLORCVT_MAX ? dest : scaled_frame;
+        cv::resize(frame, out, { W, H }, 0, 0, cv::INTER_NEAREST);
+        scaled = &out;
     }
-    else
-        color = scaled;
 
-    int width = color->cols, height = color->rows;
-    unsigned stride = color->step.p[0];
-    set_image(color->data, width, height, stride, QImage::Format_ARGB32);
+    if (color_cvt != cv::COLOR_COLORCVT_MAX)
+        cv::cvtColor(*scaled, dest, color_cvt);
+    else if (scaled != &dest)
+        scaled->copyTo(dest);
 
-    set_fresh(true);
+    swap_buffers();
 }
@@ -16,5 +16,5 @@ struct cv_video_widget final : video_widget
     void update_image(const cv::Mat& frame);
 
 private:
-    cv::Mat frame2, frame3;
+    cv::Mat scaled_frame;
 };
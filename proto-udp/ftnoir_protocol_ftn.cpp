@@ -9,9 +9,13 @@
  * copyright notice and this permission notice appear in all copies.             *
  */
 #include "ftnoir_protocol_ftn.h"
+#include "compat/udp-packet.hpp"
 #include <QFile>
 #include "api/plugin-api.hpp"
 
+#include <chrono>
+#include <cstring>
+
 udp::udp()
 {
     set_dest_address();
@@ -25,7 +29,20 @@ void udp::pose(const double *headpose, const double*)
 {
     QMutexLocker l(&lock);
 
-    outSocket.writeDatagram((const char *) headpose, sizeof(double[6]), dest_ip, dest_port);
+    if (!extended_format)
+    {
+        outSocket.writeDatagram((const char *) headpose, sizeof(double[6]), dest_ip, dest_port);
+        return;
+    }
+
+    using namespace std::chrono;
+    udp_packet::extended packet;
+    packet.magic = udp_packet::extended::magic_value;
+    packet.sequence = sequence++;
+    packet.timestamp_us = (uint64_t)duration_cast<microseconds>(system_clock::now().time_since_epoch()).count();
+    memcpy(packet.pose, headpose, sizeof(packet.pose));
+
+    outSocket.writeDatagram((const char *) &packet, sizeof(packet), dest_ip, dest_port);
 }
 
 void udp::set_dest_address()
@@ -33,6 +50,7 @@ void udp::set_dest_address()
     QMutexLocker l(&lock);
 
     dest_port = (unsigned short)s.port;
+    extended_format = s.extended_format;
     dest_ip = QHostAddress((s.ip1.to<unsigned>() & 0xff) << 24 |
                            (s.ip2.to<unsigned>() & 0xff) << 16 |
                            (s.ip3.to<unsigned>() & 0xff) << 8  |
@@ -18,13 +18,15 @@ using namespace options;
 
 struct settings : opts {
     value<int> ip1, ip2, ip3, ip4, port;
+    value<bool> extended_format;
     settings() :
         opts("udp-proto"),
         ip1(b, "ip1", 192),
         ip2(b, "ip2", 168),
         ip3(b, "ip3", 0),
         ip4(b, "ip4", 2),
-        port(b, "port", 4242)
+        port(b, "port", 4242),
+        extended_format(b, "extended-format", false)
     {}
 };
 
@@ -45,6 +47,8 @@ private:
 
     QHostAddress dest_ip { 127u << 24 | 1u };
     unsigned short dest_port = 65535;
+    bool extended_format = false;
+    uint32_t sequence = 0;
 
 private slots:
     void set_dest_address();
@@ -20,6 +20,7 @@ FTNControls::FTNControls()
     tie_setting(s.ip3, ui.spinIPThirdNibble);
     tie_setting(s.ip4, ui.spinIPFourthNibble);
     tie_setting(s.port, ui.spinPortNumber);
+    tie_setting(s.extended_format, ui.extended_format);
 
     connect(ui.buttonBox, &QDialogButtonBox::accepted, this, &FTNControls::doOK);
     connect(ui.buttonBox, &QDialogButtonBox::rejected, this, &FTNControls::doCancel);
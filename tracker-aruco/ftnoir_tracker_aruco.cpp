@@ -31,6 +31,7 @@
 #include <cmath>
 #include <algorithm>
 #include <iterator>
+#include <thread>
 
 static const int adaptive_sizes[] =
 {
@@ -46,6 +47,54 @@ static const int adaptive_sizes[] =
 #endif
 };
 
+#if !defined USE_EXPERIMENTAL_CANNY
+static constexpr int adaptive_thres = 6;
+#else
+static constexpr int adaptive_thres = 3;
+#endif
+
+// thresholding settings cycled through when the marker is lost
+struct detection_params final
+{
+    bool otsu;
+    unsigned size_pos;
+};
+
+#if !defined USE_EXPERIMENTAL_CANNY
+static constexpr unsigned ndetection_params = 2 * std::size(adaptive_sizes);
+#else
+static constexpr unsigned ndetection_params = std::size(adaptive_sizes);
+#endif
+
+// k-th setting after the current one, in the order they used to be cycled through one per frame
+static detection_params nth_detection_params(bool otsu, unsigned size_pos, unsigned k)
+{
+#if !defined USE_EXPERIMENTAL_CANNY
+    unsigned idx = size_pos * 2 + otsu + k + 1;
+    return { bool(idx % 2), unsigned(idx / 2 % std::size(adaptive_sizes)) };
+#else
+    (void)otsu;
+    return { false, unsigned((size_pos + k + 1) % std::size(adaptive_sizes)) };
+#endif
+}
+
+static void configure_detector(aruco::MarkerDetector& detector, detection_params p)
+{
+    detector.setDesiredSpeed(3);
+#if !defined USE_EXPERIMENTAL_CANNY
+    if (p.otsu)
+        detector._thresMethod = aruco::MarkerDetector::FIXED_THRES;
+    else
+        detector._thresMethod = aruco::MarkerDetector::ADPT_THRES;
+
+    detector.setThresholdParams(adaptive_sizes[p.size_pos], adaptive_thres);
+#else
+    detector._thresMethod = aruco::MarkerDetector::CANNY;
+    int value = adaptive_sizes[p.size_pos];
+    detector.setThresholdParams(value, value * 3);
+#endif
+}
+
 struct resolution_tuple
 {
     int width;
@@ -125,6 +174,30 @@ bool aruco_tracker::detect_with_roi()
     return false;
 }
 
+// a miss usually means fast motion, try at half resolution before the full search
+bool aruco_tracker::detect_decimated()
+{
+    if (grayscale.cols < decimate_min_width)
+        return false;
+
+    cv::resize(grayscale, decimated, { grayscale.cols/2, grayscale.rows/2 }, 0, 0, cv::INTER_AREA);
+
+    detector.setMinMaxSize(size_min, size_max);
+    detector.detect(decimated, markers, cv::Mat(), cv::Mat(), -1, false);
+
+    if (markers.size() != 1 || markers[0].size() != 4)
+        return false;
+
+    auto& m = markers[0];
+    for (unsigned i = 0; i < 4; i++)
+        m[i] = m[i] * 2 + cv::Point2f(.5f, .5f);
+
+    cv::cornerSubPix(grayscale, m, { 3, 3 }, { -1, -1 },
+                     cv::TermCriteria(cv::TermCriteria::EPS | cv::TermCriteria::COUNT, 10, .01));
+
+    return true;
+}
+
 bool aruco_tracker::detect_without_roi()
 {
     detector.setMinMaxSize(size_min, size_max);
@@ -164,7 +237,7 @@ bool aruco_tracker::open_camera()
 
     QMutexLocker l(&camera_mtx);
 
-    camera = video::make_camera(s.camera_name);
+    camera = video::make_camera(video::resolve_camera_name(s.camera_name, s.camera_id));
 
     if (!camera)
         return false;
@@ -178,6 +251,7 @@ bool aruco_tracker::open_camera()
     }
     if (fps)
         args.fps = fps;
+    args.accept_luma = true;
 
     if (!camera->start(args))
     {
@@ -301,58 +375,84 @@ void aruco_tracker::set_rmat()
 
 void aruco_tracker::set_roi_from_projection()
 {
-    last_roi = cv::Rect(color.cols-1, color.rows-1, 0, 0);
+    cv::Point2f min = roi_projection[0], max = roi_projection[0];
 
-    for (unsigned i = 0; i < 4; i++)
+    for (unsigned i = 1; i < 4; i++)
     {
         const auto& proj = roi_projection[i];
-        int min_x = std::min(int(proj.x), last_roi.x),
-            min_y = std::min(int(proj.y), last_roi.y);
+        min = { std::min(min.x, proj.x), std::min(min.y, proj.y) };
+        max = { std::max(max.x, proj.x), std::max(max.y, proj.y) };
+    }
 
-        int max_x = std::max(int(proj.x), last_roi.width),
-            max_y = std::max(int(proj.y), last_roi.height);
+    // move the window to where the marker is headed and widen it by the
+    // distance it travels, prediction is only as good as constant velocity
+    const cv::Point2f v = roi_velocity;
+    const float margin = .5f * std::max(std::fabs(v.x), std::fabs(v.y));
 
-        last_roi.x = min_x;
-        last_roi.y = min_y;
+    min += v - cv::Point2f(margin, margin);
+    max += v + cv::Point2f(margin, margin);
 
-        last_roi.width = max_x;
-        last_roi.height = max_y;
-    }
+    last_roi = cv::Rect(cv::Point(int(std::floor(min.x)), int(std::floor(min.y))),
+                        cv::Point(int(std::ceil(max.x)), int(std::ceil(max.y))));
 
     clamp_last_roi();
 }
 
-void aruco_tracker::set_detector_params()
+void aruco_tracker::update_roi_velocity()
 {
-    detector.setDesiredSpeed(3);
-#if !defined USE_EXPERIMENTAL_CANNY
-    if (use_otsu)
-        detector._thresMethod = aruco::MarkerDetector::FIXED_THRES;
+    const auto& m = markers[0];
+    const cv::Point2f center = (m[0] + m[1] + m[2] + m[3]) * .25f;
+
+    if (have_last_center)
+        roi_velocity = center - last_center;
     else
-        detector._thresMethod = aruco::MarkerDetector::ADPT_THRES;
+        roi_velocity = {};
 
-    detector.setThresholdParams(adaptive_sizes[adaptive_size_pos], adaptive_thres);
-#else
-    detector._thresMethod = aruco::MarkerDetector::CANNY;
-    int value = adaptive_sizes[adaptive_size_pos];
-    detector.setThresholdParams(value, value * 3);
-#endif
+    last_center = center;
+    have_last_center = true;
 }
 
-void aruco_tracker::cycle_detection_params()
+void aruco_tracker::set_detector_params()
 {
-#if !defined USE_EXPERIMENTAL_CANNY
-    if (!use_otsu)
-        use_otsu = true;
-    else
-#endif
-    {
-        use_otsu = false;
+    configure_detector(detector, { use_otsu, adaptive_size_pos });
+}
+
+// try every other thresholding setting on the current frame at once,
+// instead of one per frame until the marker shows up again
+void aruco_tracker::search_detection_params()
+{
+    constexpr unsigned n = ndetection_params - 1;
 
-        adaptive_size_pos++;
-        adaptive_size_pos %= std::size(adaptive_sizes);
+    if (!pool)
+    {
+        const unsigned nthreads = std::clamp(std::thread::hardware_concurrency(), 1u, n);
+        pool = std::make_unique<worker_pool>(nthreads, "tracker/aruco/search");
+        search_detectors = std::make_unique<aruco::MarkerDetector[]>(n);
     }
 
+    bool found[n] {};
+
+    pool->run(n, [&](unsigned k) {
+        aruco::MarkerDetector& d = search_detectors[k];
+        std::vector<aruco::Marker> candidates;
+
+        configure_detector(d, nth_detection_params(use_otsu, adaptive_size_pos, k));
+        d.setMinMaxSize(size_min, size_max);
+        d.detect(grayscale, candidates, cv::Mat(), cv::Mat(), -1, false);
+
+        found[k] = candidates.size() == 1 && candidates[0].size() == 4;
+    });
+
+    // keep whichever the old one-per-frame cycle would have reached first
+    const bool* const it = std::find(found, found + n, true);
+
+    if (it == found + n)
+        return;
+
+    const detection_params p = nth_detection_params(use_otsu, adaptive_size_pos, unsigned(it - found));
+    use_otsu = p.otsu;
+    adaptive_size_pos = p.size_pos;
+
     set_detector_params();
 
     qDebug() << "aruco: switched thresholding params"
@@ -388,7 +488,7 @@ void aruco_tracker::run()
             switch (img.channels)
             {
             case 1:
-                grayscale.setTo(color); break;
+                color.copyTo(grayscale); break;
             case 3:
                 cv::cvtColor(color, grayscale, cv::COLOR_BGR2GRAY);
                 break;
@@ -408,7 +508,10 @@ void aruco_tracker::run()
         }
 #endif
 
-        color.copyTo(frame);
+        if (color.channels() == 1)
+            cv::cvtColor(color, frame, cv::COLOR_GRAY2BGR);
+        else
+            color.copyTo(frame);
 
         set_intrinsics();
 
@@ -416,7 +519,7 @@ void aruco_tracker::run()
 
         markers.clear();
 
-        const bool ok = detect_with_roi() || detect_without_roi();
+        const bool ok = detect_with_roi() || detect_decimated() || detect_without_roi();
 
         if (ok)
         {
@@ -432,6 +535,7 @@ void aruco_tracker::run()
                 no_detection_timeout = std::fmax(0., no_detection_timeout);
             }
 
+            update_roi_velocity();
             set_last_roi();
             draw_centroid();
             set_rmat();
@@ -441,6 +545,8 @@ void aruco_tracker::run()
 fail:
             // no marker found, reset search region
             last_roi = cv::Rect(65535, 65535, 0, 0);
+            have_last_center = false;
+            roi_velocity = {};
 
             const double dt = last_detection_timer.elapsed_seconds();
             last_detection_timer.start();
@@ -448,7 +554,7 @@ fail:
             if (no_detection_timeout > timeout)
             {
                 no_detection_timeout = 0;
-                cycle_detection_params();
+                search_detection_params();
             }
         }
 
@@ -518,6 +624,9 @@ aruco_dialog::aruco_dialog() :
         ui.cameraName->addItem(str);
 
     tie_setting(s.camera_name, ui.cameraName);
+    // only on user selection, the saved id must survive the saved name now meaning another camera
+    connect(ui.cameraName, static_cast<void(QComboBox::*)(int)>(&QComboBox::activated), this,
+            [this](int) { s.camera_id = video::camera_id(ui.cameraName->currentText()); });
     tie_setting(s.resolution, ui.resolution);
     tie_setting(s.fov, ui.cameraFOV);
     tie_setting(s.headpos_x, ui.cx);
@@ -14,6 +14,7 @@
 #include "cv/video-widget.hpp"
 #include "compat/timer.hpp"
 #include "video/camera.hpp"
+#include "compat/worker-pool.hpp"
 
 #include "aruco/markerdetector.h"
 
@@ -59,6 +60,7 @@ struct settings : opts {
                   headpos_z { b, "headpos-z", 0 };
 
     value<QString> camera_name { b, "camera-name", ""};
+    value<QString> camera_id { b, "camera-id", ""};
     value<int> resolution { b, "force-resolution", 0 };
     value<int> fov { b, "field-of-view", 56 };
     value<aruco_fps> force_fps { b, "force-fps", fps_default };
@@ -83,6 +85,7 @@ public:
 
 private:
     bool detect_with_roi();
+    bool detect_decimated();
     bool detect_without_roi();
     bool open_camera();
     void set_intrinsics();
@@ -94,8 +97,9 @@ private:
     void set_last_roi();
     void set_rmat();
     void set_roi_from_projection();
+    void update_roi_velocity();
     void set_detector_params();
-    void cycle_detection_params();
+    void search_detection_params();
 
     QMutex mtx;
     std::unique_ptr<cv_video_widget> videoWidget;
@@ -114,19 +118,19 @@ private:
     std::vector<cv::Point2f> repr2;
     std::vector<cv::Point3f> obj_points {4};
     aruco::MarkerDetector detector;
+    // one detector per thresholding candidate, they can't be shared between threads
+    std::unique_ptr<aruco::MarkerDetector[]> search_detectors;
+    std::unique_ptr<worker_pool> pool;
     std::vector<aruco::Marker> markers;
-    cv::Mat frame, grayscale, color;
+    cv::Mat frame, grayscale, color, decimated;
     cv::Rect last_roi { 65535, 65535, 0, 0 };
+    // marker motion in pixels per frame, to place the next frame's ROI
+    cv::Point2f last_center, roi_velocity;
+    bool have_last_center = false;
     Timer fps_timer, last_detection_timer;
     unsigned adaptive_size_pos { 0 };
     bool use_otsu = false;
 
-#if !defined USE_EXPERIMENTAL_CANNY
-    static constexpr int adaptive_thres = 6;
-#else
-    static constexpr int adaptive_thres = 3;
-#endif
-
     static constexpr double timeout = .35;
     static constexpr double timeout_backoff_c = .25;
 
@@ -135,6 +139,9 @@ private:
 
     static constexpr double RC = .25;
 
+    // below this the decimated image is too small to find the marker in
+    static constexpr int decimate_min_width = 640;
+
 #ifdef DEBUG_UNSHARP_MASKING
     static constexpr double gauss_kernel_size = 3;
     cv::Mat blurred;
@@ -0,0 +1,150 @@
+// Times KalmanFilterPose::Update against the 18-state cv::KalmanFilter it
+// replaced, and checks that both produce the same estimates.
+//
+// usage: tracker-easy-bench [updates] [fps]
+
+#include "../kalman-filter-pose.h"
+#include "compat/timer.hpp"
+#include "compat/math-imports.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include <opencv2/video/tracking.hpp>
+
+#include <QCoreApplication>
+#include <QStringList>
+
+namespace {
+
+// the former filter, kept as the reference
+class reference_filter final : public cv::KalmanFilter
+{
+public:
+    explicit reference_filter(double dt)
+    {
+        init(18, 6, 0, CV_64F);
+
+        setIdentity(processNoiseCov, cv::Scalar::all(1));
+        setIdentity(measurementNoiseCov, cv::Scalar::all(1));
+        setIdentity(errorCovPost, cv::Scalar::all(1));
+
+        // position, velocity, acceleration for translation, then for the angles
+        for (int base : { 0, 9 })
+            for (int i = 0; i < 3; i++)
+            {
+                transitionMatrix.at<double>(base + i, base + 3 + i) = dt;
+                transitionMatrix.at<double>(base + 3 + i, base + 6 + i) = dt;
+                transitionMatrix.at<double>(base + i, base + 6 + i) = 0.5 * dt * dt;
+            }
+
+        for (int i = 0; i < 3; i++)
+        {
+            measurementMatrix.at<double>(i, i) = 1;
+            measurementMatrix.at<double>(3 + i, 9 + i) = 1;
+        }
+    }
+
+    void update(double (&x)[6])
+    {
+        for (int i = 0; i < 6; i++)
+            measurement(i) = x[i];
+
+        (void)predict();
+        const cv::Mat& estimated = correct(measurement);
+
+        for (int i = 0; i < 3; i++)
+        {
+            x[i] = estimated.at<double>(i);
+            x[3 + i] = estimated.at<double>(9 + i);
+        }
+    }
+
+private:
+    cv::Mat1d measurement { 6, 1 };
+};
+
+} // ns
+
+int main(int argc, char** argv)
+{
+    QCoreApplication app(argc, argv);
+    const QStringList args = app.arguments();
+
+    const unsigned updates = args.size() > 1 ? args[1].toUInt() : 100000;
+    const int fps = args.size() > 2 ? std::max(1, args[2].toInt()) : 30;
+
+    if (!updates)
+    {
+        std::fprintf(stderr, "usage: %s [updates] [fps]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // same as Tracker::DoSetFps()
+    const double dt = 1000.0 / fps;
+
+    EasyTracker::KalmanFilterPose filter;
+    filter.Init(dt);
+    reference_filter reference(dt);
+
+    // a slow head motion with measurement noise, mm and degrees
+    std::vector<std::array<double, 6>> input(updates);
+    std::mt19937 rng{42};
+    std::normal_distribution<double> noise{0, .5};
+
+    for (unsigned i = 0; i < updates; i++)
+    {
+        const double t = i / (double)fps;
+        input[i] = { 40 * sin(t * .7) + noise(rng), 25 * sin(t * .9) + noise(rng), 600 + 50 * sin(t * .5) + noise(rng),
+                     5 * sin(t * 1.1) + noise(rng), 15 * sin(t * .6) + noise(rng), 30 * sin(t * .8) + noise(rng) };
+    }
+
+    std::vector<std::array<double, 6>> out(updates), expected(updates);
+
+    Timer timer;
+    for (unsigned i = 0; i < updates; i++)
+    {
+        auto& x = out[i];
+        x = input[i];
+        filter.Update(x[0], x[1], x[2], x[3], x[4], x[5]);
+    }
+    const double filter_ms = timer.elapsed_ms();
+
+    timer.start();
+    for (unsigned i = 0; i < updates; i++)
+    {
+        double x[6];
+        std::copy(input[i].cbegin(), input[i].cend(), x);
+        reference.update(x);
+        std::copy(x, x + 6, expected[i].begin());
+    }
+    const double reference_ms = timer.elapsed_ms();
+
+    double max_error = 0;
+    for (unsigned i = 0; i < updates; i++)
+        for (int k = 0; k < 6; k++)
+        {
+            const double a = out[i][k], b = expected[i][k];
+            max_error = std::max(max_error, std::fabs(a - b) / std::max({ 1., std::fabs(a), std::fabs(b) }));
+        }
+
+    std::printf("KalmanFilterPose:  %8.3f us/update\n"
+                "cv::KalmanFilter:  %8.3f us/update\n"
+                "max relative error %g over %u updates\n",
+                filter_ms * 1000 / updates, reference_ms * 1000 / updates,
+                max_error, updates);
+
+    constexpr double max_allowed_error = 1e-14;
+
+    if (!(max_error <= max_allowed_error))
+    {
+        std::fprintf(stderr, "estimates differ by more than %g\n", max_allowed_error);
+        return EXIT_FAILURE;
+    }
+
+    return 0;
+}
@@ -13,106 +13,69 @@ namespace EasyTracker
 
     KalmanFilterPose::KalmanFilterPose()
     {
-
+        Init(0);
     }
 
 
-    void KalmanFilterPose::Init(int nStates, int nMeasurements, int nInputs, double dt)
+    void KalmanFilterPose::Init(double dt)
     {
-        iMeasurements = cv::Mat(nMeasurements, 1, CV_64FC1);
-
-        init(nStates, nMeasurements, nInputs, CV_64F);                 // init Kalman Filter
-
-        // TODO: Use parameters instead of magic numbers
-        setIdentity(processNoiseCov, cv::Scalar::all(1)); //1e-5      // set process noise
-        setIdentity(measurementNoiseCov, cv::Scalar::all(1)); //1e-2   // set measurement noise
-        setIdentity(errorCovPost, cv::Scalar::all(1));             // error covariance
-
         /** DYNAMIC MODEL **/
 
-        //  [1 0 0 dt  0  0 dt2   0   0 0 0 0  0  0  0   0   0   0]
-        //  [0 1 0  0 dt  0   0 dt2   0 0 0 0  0  0  0   0   0   0]
-        //  [0 0 1  0  0 dt   0   0 dt2 0 0 0  0  0  0   0   0   0]
-        //  [0 0 0  1  0  0  dt   0   0 0 0 0  0  0  0   0   0   0]
-        //  [0 0 0  0  1  0   0  dt   0 0 0 0  0  0  0   0   0   0]
-        //  [0 0 0  0  0  1   0   0  dt 0 0 0  0  0  0   0   0   0]
-        //  [0 0 0  0  0  0   1   0   0 0 0 0  0  0  0   0   0   0]
-        //  [0 0 0  0  0  0   0   1   0 0 0 0  0  0  0   0   0   0]
-        //  [0 0 0  0  0  0   0   0   1 0 0 0  0  0  0   0   0   0]
-        //  [0 0 0  0  0  0   0   0   0 1 0 0 dt  0  0 dt2   0   0]
-        //  [0 0 0  0  0  0   0   0   0 0 1 0  0 dt  0   0 dt2   0]
-        //  [0 0 0  0  0  0   0   0   0 0 0 1  0  0 dt   0   0 dt2]
-        //  [0 0 0  0  0  0   0   0   0 0 0 0  1  0  0  dt   0   0]
-        //  [0 0 0  0  0  0   0   0   0 0 0 0  0  1  0   0  dt   0]
-        //  [0 0 0  0  0  0   0   0   0 0 0 0  0  0  1   0   0  dt]
-        //  [0 0 0  0  0  0   0   0   0 0 0 0  0  0  0   1   0   0]
-        //  [0 0 0  0  0  0   0   0   0 0 0 0  0  0  0   0   1   0]
-        //  [0 0 0  0  0  0   0   0   0 0 0 0  0  0  0   0   0   1]
-
-        // position
-        transitionMatrix.at<double>(0, 3) = dt;
-        transitionMatrix.at<double>(1, 4) = dt;
-        transitionMatrix.at<double>(2, 5) = dt;
-        transitionMatrix.at<double>(3, 6) = dt;
-        transitionMatrix.at<double>(4, 7) = dt;
-        transitionMatrix.at<double>(5, 8) = dt;
-        transitionMatrix.at<double>(0, 6) = 0.5*pow(dt, 2);
-        transitionMatrix.at<double>(1, 7) = 0.5*pow(dt, 2);
-        transitionMatrix.at<double>(2, 8) = 0.5*pow(dt, 2);
-
-        // orientation
-        transitionMatrix.at<double>(9, 12) = dt;
-        transitionMatrix.at<double>(10, 13) = dt;
-        transitionMatrix.at<double>(11, 14) = dt;
-        transitionMatrix.at<double>(12, 15) = dt;
-        transitionMatrix.at<double>(13, 16) = dt;
-        transitionMatrix.at<double>(14, 17) = dt;
-        transitionMatrix.at<double>(9, 15) = 0.5*pow(dt, 2);
-        transitionMatrix.at<double>(10, 16) = 0.5*pow(dt, 2);
-        transitionMatrix.at<double>(11, 17) = 0.5*pow(dt, 2);
-
+        // Per axis block of the former 18x18 transition matrix
+        //  [1 dt dt2]
+        //  [0  1  dt]
+        //  [0  0   1]
+        iTransition = cv::Matx33d(1, dt, 0.5 * dt * dt,
+                                  0,  1, dt,
+                                  0,  0, 1);
 
-        /** MEASUREMENT MODEL **/
+        for (Axis& axis : iAxes)
+            axis.Reset();
+    }
 
-        //  [1 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0]
-        //  [0 1 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0]
-        //  [0 0 1 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0]
-        //  [0 0 0 0 0 0 0 0 0 1 0 0 0 0 0 0 0 0]
-        //  [0 0 0 0 0 0 0 0 0 0 1 0 0 0 0 0 0 0]
-        //  [0 0 0 0 0 0 0 0 0 0 0 1 0 0 0 0 0 0]
+    void KalmanFilterPose::Axis::Reset()
+    {
+        iState = cv::Vec3d::all(0);
+        // TODO: Use parameters instead of magic numbers
+        iErrorCov = cv::Matx33d::eye();             // error covariance
+    }
 
-        // Those will scale the filtered values, 2 will give you half the raw input
-        measurementMatrix.at<double>(0, 0) = 1;  // x
-        measurementMatrix.at<double>(1, 1) = 1;  // y
-        measurementMatrix.at<double>(2, 2) = 1;  // z
-        measurementMatrix.at<double>(3, 9) = 1;  // roll
-        measurementMatrix.at<double>(4, 10) = 1; // pitch
-        measurementMatrix.at<double>(5, 11) = 1; // yaw
+    ///
+    /// Same as cv::KalmanFilter predict then correct with:
+    /// process noise = I, measurement noise = 1 and measurement matrix = [1 0 0].
+    ///
+    double KalmanFilterPose::Axis::Update(const cv::Matx33d& aTransition, double aMeasurement)
+    {
+        // Predict
+        const cv::Vec3d statePre = aTransition * iState;
+        cv::Matx33d errorCovPre = aTransition * iErrorCov * aTransition.t();
+        // Process noise
+        errorCovPre(0, 0) += 1; //1e-5
+        errorCovPre(1, 1) += 1;
+        errorCovPre(2, 2) += 1;
+
+        // Correct, only position is measured so the innovation covariance is a scalar
+        const double s = errorCovPre(0, 0) + 1; //1e-2      // measurement noise
+        const cv::Vec3d gain(errorCovPre(0, 0) / s, errorCovPre(1, 0) / s, errorCovPre(2, 0) / s);
+        iState = statePre + gain * (aMeasurement - statePre[0]);
+        // errorCovPost = errorCovPre - K * H * errorCovPre, where H * errorCovPre is the first row of errorCovPre
+        for (int i = 0; i < 3; i++)
+            for (int j = 0; j < 3; j++)
+                iErrorCov(i, j) = errorCovPre(i, j) - gain[i] * errorCovPre(0, j);
+
+        return iState[0];
     }
 
     void KalmanFilterPose::Update(double& aX, double& aY, double& aZ, double& aRoll, double& aPitch, double& aYaw)
     {
-        // Set measurement to predict
-        iMeasurements.at<double>(0) = aX; // x
-        iMeasurements.at<double>(1) = aY; // y
-        iMeasurements.at<double>(2) = aZ; // z
-        iMeasurements.at<double>(3) = aRoll;      // roll
-        iMeasurements.at<double>(4) = aPitch;      // pitch
-        iMeasurements.at<double>(5) = aYaw;      // yaw
-
-        // First predict, to update the internal statePre variable
-        cv::Mat prediction = predict();
-        // The "correct" phase that is going to use the predicted value and our measurement
-        cv::Mat estimated = correct(iMeasurements);
         // Estimated translation
-        aX = estimated.at<double>(0);
-        aY = estimated.at<double>(1);
-        aZ = estimated.at<double>(2);
-        // Estimated euler angles        
-        aRoll = estimated.at<double>(9);
-        aPitch = estimated.at<double>(10);
-        aYaw = estimated.at<double>(11);
+        aX = iAxes[0].Update(iTransition, aX);
+        aY = iAxes[1].Update(iTransition, aY);
+        aZ = iAxes[2].Update(iTransition, aZ);
+        // Estimated euler angles
+        aRoll = iAxes[3].Update(iTransition, aRoll);
+        aPitch = iAxes[4].Update(iTransition, aPitch);
+        aYaw = iAxes[5].Update(iTransition, aYaw);
     }
 
 }
-
@@ -9,24 +9,43 @@
 #pragma once
 
 #include <opencv2/core.hpp>
-#include <opencv2/video/tracking.hpp>
 
 
 namespace EasyTracker
 {
 
+    ///
+    /// Constant acceleration Kalman filter over translation and euler angles.
+    /// Process and measurement noise as well as initial error covariance are identity,
+    /// therefore the 18 states model decouples into six independent position, velocity, acceleration filters.
+    /// We run those on fixed size matrices so that updates never allocate.
     ///
     /// TODO: do not use a constant time difference
     ///
-    class KalmanFilterPose: public cv::KalmanFilter
+    class KalmanFilterPose
     {
     public:
         KalmanFilterPose();
-        void Init(int aStateCount, int aMeasurementCount, int aInputCount, double aDt);
+        void Init(double aDt);
         void Update(double& aX, double& aY, double& aZ, double& aRoll, double& aPitch, double& aYaw);
 
+    private:
+        ///
+        /// One axis: state is position, velocity and acceleration, only position is measured.
+        ///
+        struct Axis
+        {
+            cv::Vec3d iState;
+            cv::Matx33d iErrorCov;
+
+            void Reset();
+            double Update(const cv::Matx33d& aTransition, double aMeasurement);
+        };
+
+        static constexpr int KAxisCount = 6;
 
-        cv::Mat iMeasurements;
+        cv::Matx33d iTransition;
+        Axis iAxes[KAxisCount];
     };
 
 }
@@ -16,3 +16,9 @@ void check_highgui()
 {
     cv::imshow("foo", cv::noArray());
 }
+
+void check_refine_lm()
+{
+    cv::Mat x;
+    cv::solvePnPRefineLM(x, x, x, x, x, x);
+}
@@ -39,29 +39,82 @@ namespace EasyTracker
     {
         iMinPointSize = iSettings.iMinBlobSize;
         iMaxPointSize = iSettings.iMaxBlobSize;
+        iIrMin = iSettings.iIrMin;
+        iIrMax = iSettings.iIrMax;
+    }
+
+    ///
+    void PointExtractor::SetRoi(const std::vector<cv::Point2f>& aPoints, const cv::Size& aFrameSize)
+    {
+        if (aPoints.empty())
+        {
+            ResetRoi();
+            return;
+        }
+
+        cv::Rect box = cv::boundingRect(aPoints);
+        // Leave room for our points to move between frames and for the blobs themselves
+        const int margin = std::max(2 * iMaxPointSize, std::max(box.width, box.height) / 2);
+        box.x -= margin;
+        box.y -= margin;
+        box.width += 2 * margin;
+        box.height += 2 * margin;
+        iRoi = box & cv::Rect(cv::Point(0, 0), aFrameSize);
+    }
+
+    ///
+    void PointExtractor::ResetRoi()
+    {
+        iRoi = cv::Rect();
     }
 
     ///
     void PointExtractor::ExtractPoints(const cv::Mat& aFrame, cv::Mat* aPreview, int aNeededPointCount, std::vector<cv::Point>& aPoints)
     {
+        const cv::Rect fullFrame(0, 0, aFrame.cols, aFrame.rows);
+        // Frame size can change under us if the camera was reopened
+        iRoi &= fullFrame;
+
+        // Only look around our last points, fall back to the full frame if we lost some
+        if (!iRoi.empty() && iRoi != fullFrame)
+        {
+            ExtractPointsInRect(aFrame, iRoi, aPreview, aPoints);
+            if (aPreview)
+            {
+                cv::rectangle(*aPreview, iRoi, CV_RGB(0, 0, 255), 1);
+            }
+
+            if ((int)aPoints.size() >= aNeededPointCount)
+            {
+                KeepHighestPoints(aNeededPointCount, aPoints);
+                return;
+            }
+
+            aPoints.clear();
+            ResetRoi();
+        }
+
+        ExtractPointsInRect(aFrame, fullFrame, aPreview, aPoints);
+        KeepHighestPoints(aNeededPointCount, aPoints);
+    }
+
+    ///
+    void PointExtractor::ExtractPointsInRect(const cv::Mat& aFrame, const cv::Rect& aRect, cv::Mat* aPreview, std::vector<cv::Point>& aPoints)
+    {
+        const cv::Mat frame = aFrame(aRect);
+
         //TODO: Assert if channel size is neither one nor two
         // Make sure our frame channel is 8 bit
-        size_t channelSize = aFrame.elemSize1();
+        size_t channelSize = frame.elemSize1();
         if (channelSize == 2)
         {
             // We have a 16 bits single channel. Typically coming from Kinect V2 IR sensor
-            // Resample to 8-bits
-            double min = std::numeric_limits<uint16_t>::min();
-            double max = std::numeric_limits<uint16_t>::max();
-            //cv::minMaxLoc(raw, &min, &max); // Should we use 16bit min and max instead?
-            // For scalling to have more precission in the range we are interrested in
-            min = max - 255;
-            // See: https://stackoverflow.com/questions/14539498/change-type-of-mat-object-from-cv-32f-to-cv-8u/14539652
-            aFrame.convertTo(iFrameChannelSizeOne, CV_8U, 255.0 / (max - min), -255.0*min / (max - min));
+            // Threshold it straight into the 8 bits mask our contour detection needs
+            cv::inRange(frame, cv::Scalar(iIrMin), cv::Scalar(iIrMax), iFrameChannelSizeOne);
         }
         else
         {
-            iFrameChannelSizeOne = aFrame;
+            iFrameChannelSizeOne = frame;
         }
 
 
@@ -84,7 +137,7 @@ namespace EasyTracker
         }
         else
         {
-            eval_once(qDebug() << "tracker/easy: camera frame depth not supported" << aFrame.channels());
+            eval_once(qDebug() << "tracker/easy: camera frame depth not supported" << frame.channels());
             return;
         }
 
@@ -100,7 +153,8 @@ namespace EasyTracker
 
         // Contours detection
         iContours.clear();
-        cv::findContours(iFrameGray, iContours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
+        // Contours come out in full frame coordinates
+        cv::findContours(iFrameGray, iContours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE, aRect.tl());
     
         // Workout which countours are valid points
         for (size_t i = 0; i < iContours.size(); i++)
@@ -135,34 +189,47 @@ namespace EasyTracker
             }
         }
 
-        // Keep only the three points which are highest, i.e. with lowest Y coordinates
+    }
+
+    ///
+    void PointExtractor::KeepHighestPoints(int aNeededPointCount, std::vector<cv::Point>& aPoints)
+    {
+        // Keep only the points which are highest, i.e. with lowest Y coordinates
         // That's most usefull to discard noise from features below your cap/head.
         // Typically noise comming from zippers and metal parts on your clothing.
         // With a cap tracker it also successfully discards noise from glasses.
         // However it may not work as good with a clip user wearing glasses.
-        while (aPoints.size() > aNeededPointCount) // Until we have no more than three points
+        if (aNeededPointCount <= 0 || (int)aPoints.size() <= aNeededPointCount)
         {
-            int maxY = 0;
-            size_t index = std::numeric_limits<size_t>::max();
+            return;
+        }
 
-            // Search for the point with highest Y coordinate
-            for (size_t i = 0; i < aPoints.size(); i++)
-            {
-                if (aPoints[i].y > maxY)
-                {
-                    maxY = aPoints[i].y;
-                    index = i;
-                }
-            }
-            
-            if (index < aPoints.size()) // Defensive
+        // Find the Y coordinate of the last point we keep, in linear time
+        iSortedY.clear();
+        for (const cv::Point& pt : aPoints)
+        {
+            iSortedY.push_back(pt.y);
+        }
+        std::nth_element(iSortedY.begin(), iSortedY.begin() + (aNeededPointCount - 1), iSortedY.end());
+        const int lastY = iSortedY[aNeededPointCount - 1];
+
+        // Points above it all go in, points level with it only until we have enough, order is preserved
+        int above = 0;
+        for (const cv::Point& pt : aPoints)
+        {
+            above += pt.y < lastY;
+        }
+        int level = aNeededPointCount - above;
+
+        size_t count = 0;
+        for (const cv::Point& pt : aPoints)
+        {
+            if (pt.y < lastY || (pt.y == lastY && level-- > 0))
             {
-                // Discard it
-                aPoints.erase(aPoints.begin() + index);
+                aPoints[count++] = pt;
             }
-            
         }
+        aPoints.resize(count);
     }
 
 }
-
@@ -27,19 +27,32 @@ namespace EasyTracker
 
         void UpdateSettings();
 
+        // Search only around these points from now on, until they are lost or ResetRoi() is called
+        void SetRoi(const std::vector<cv::Point2f>& aPoints, const cv::Size& aFrameSize);
+        void ResetRoi();
+
         // Settings
         Settings iSettings;
-        // Our frame with a channel size of 8 bits
+        // Our frame with a channel size of 8 bits, or points masked out of a 16 bits frame
         cv::Mat iFrameChannelSizeOne;
         // Our frame with a single 8 bits channel
         cv::Mat iFrameGray;
         //
         std::vector<std::vector<cv::Point> > iContours;
+        // Region we expect our points in, empty for full frame
+        cv::Rect iRoi;
+        // Scratch buffer for point selection
+        std::vector<int> iSortedY;
 
         // Take a copy of settings to avoid dead lock
         int iMinPointSize;
         int iMaxPointSize;
+        int iIrMin;
+        int iIrMax;
 
+    private:
+        void ExtractPointsInRect(const cv::Mat& aFrame, const cv::Rect& aRect, cv::Mat* aPreview, std::vector<cv::Point>& aPoints);
+        void KeepHighestPoints(int aNeededPointCount, std::vector<cv::Point>& aPoints);
     };
 
 }
@@ -20,11 +20,14 @@ namespace EasyTracker {
         using slider_value = options::slider_value;
 
         value<QString> camera_name{ b, "camera-name", "" };
+        value<QString> camera_id{ b, "camera-id", "" };
         value<int> cam_res_x{ b, "camera-res-width", 640 },
             cam_res_y{ b, "camera-res-height", 480 },
             cam_fps{ b, "camera-fps", 30 };
         value<int> iMinBlobSize{ b, "iMinBlobSize", 4 }, iMaxBlobSize{ b, "iMaxBlobSize", 15 };
         value<int> DeadzoneRectHalfEdgeSize { b, "deadzone-rect-half-edge-size", 1 };
+        // Window of 16-bit infrared values counted as points, defaults match the former 8-bit resampling
+        value<int> iIrMin { b, "ir-window-min", 65281 }, iIrMax { b, "ir-window-max", 65535 };
 
         // Type of custom model
         value<bool> iCustomModelThree{ b, "iCustomModelThree", true };
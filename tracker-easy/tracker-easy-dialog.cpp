@@ -36,6 +36,9 @@ namespace EasyTracker
             ui.camdevice_combo->addItem(str);
 
         tie_setting(s.camera_name, ui.camdevice_combo);
+        // only on user selection, the saved id must survive the saved name now meaning another camera
+        connect(ui.camdevice_combo, static_cast<void(QComboBox::*)(int)>(&QComboBox::activated), this,
+                [this](int) { s.camera_id = video::camera_id(ui.camdevice_combo->currentText()); });
         tie_setting(s.cam_res_x, ui.res_x_spin);
         tie_setting(s.cam_res_y, ui.res_y_spin);
         tie_setting(s.cam_fps, ui.fps_spin);
@@ -43,6 +46,8 @@ namespace EasyTracker
         tie_setting(s.iMinBlobSize, ui.mindiam_spin);
         tie_setting(s.iMaxBlobSize, ui.maxdiam_spin);
         tie_setting(s.DeadzoneRectHalfEdgeSize, ui.spinDeadzone);
+        tie_setting(s.iIrMin, ui.iSpinBoxIrMin);
+        tie_setting(s.iIrMax, ui.iSpinBoxIrMax);
 
         tie_setting(s.iVertexTopX, ui.iSpinVertexTopX);
         tie_setting(s.iVertexTopY, ui.iSpinVertexTopY);
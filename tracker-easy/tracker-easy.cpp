@@ -10,6 +10,7 @@
 #include "compat/math-imports.hpp"
 #include "compat/check-visible.hpp"
 #include "compat/sleep.hpp"
+#include "compat/thread-name.hpp"
 #include "point-extractor.h"
 #include "cv/init.hpp"
 
@@ -21,6 +22,7 @@
 #include <opencv2/calib3d.hpp>
 #include <opencv2/highgui/highgui.hpp>
 
+#include <cfloat>
 #include <iostream>
 
 #ifdef __GNUC__
@@ -44,6 +46,10 @@ using namespace options;
 
 // We need at least 3 vertices to be able to do anything
 const int KMinVertexCount = 3;
+// Levenberg-Marquardt iterations when refining last frame's pose
+const int KRefineIterations = 5;
+// Reprojection error in pixels a refined pose may have on top of twice our last full solve error
+const double KRefineMaxErrorSlack = 1.0;
 
 
 
@@ -70,6 +76,8 @@ namespace EasyTracker
         // Update point extractor whenever some of the settings it needs are changed
         connect(&iSettings.iMinBlobSize, value_::value_changed<int>(), this, &Tracker::UpdateSettings, Qt::DirectConnection);
         connect(&iSettings.iMaxBlobSize, value_::value_changed<int>(), this, &Tracker::UpdateSettings, Qt::DirectConnection);
+        connect(&iSettings.iIrMin, value_::value_changed<int>(), this, &Tracker::UpdateSettings, Qt::DirectConnection);
+        connect(&iSettings.iIrMax, value_::value_changed<int>(), this, &Tracker::UpdateSettings, Qt::DirectConnection);
 
         // Make sure solver is updated whenever the settings are changed
         connect(&iSettings.PnpSolver, value_::value_changed<int>(), this, &Tracker::UpdateSettings, Qt::DirectConnection);
@@ -100,8 +108,8 @@ namespace EasyTracker
 
     Tracker::~Tracker()
     {
-        iThread.exit();
-        iThread.wait();        
+        requestInterruption();
+        wait();
 
         if (iDebug)
             cv::destroyWindow("Preview");
@@ -114,23 +122,16 @@ namespace EasyTracker
     }
 
 
-    // Compute Euler angles from rotation matrix
-    void getEulerAngles(cv::Mat &rotCamerMatrix, cv::Vec3d &eulerAngles)
+    ///
+    /// Compute Euler angles in degrees from rotation matrix.
+    /// Closed form of what cv::decomposeProjectionMatrix gives us, that is R = Rz * Ry * Rx.
+    ///
+    void getEulerAngles(const cv::Matx33d& aRotation, cv::Vec3d& aEulerAngles)
     {
-        cv::Mat cameraMatrix, rotMatrix, transVect, rotMatrixX, rotMatrixY, rotMatrixZ;
-        double* _r = rotCamerMatrix.ptr<double>();
-        double projMatrix[12] = { _r[0],_r[1],_r[2],0,
-                              _r[3],_r[4],_r[5],0,
-                              _r[6],_r[7],_r[8],0 };
-
-        cv::decomposeProjectionMatrix(cv::Mat(3, 4, CV_64FC1, projMatrix),
-            cameraMatrix,
-            rotMatrix,
-            transVect,
-            rotMatrixX,
-            rotMatrixY,
-            rotMatrixZ,
-            eulerAngles);
+        const double KRadToDeg = 180.0 / M_PI;
+        aEulerAngles[0] = std::atan2(aRotation(2, 1), aRotation(2, 2)) * KRadToDeg;
+        aEulerAngles[1] = std::atan2(-aRotation(2, 0), std::hypot(aRotation(2, 1), aRotation(2, 2))) * KRadToDeg;
+        aEulerAngles[2] = std::atan2(aRotation(1, 0), aRotation(0, 0)) * KRadToDeg;
     }
 
     ///
@@ -399,6 +400,62 @@ namespace EasyTracker
 
 
     ///
+    /// Solve our 4 or 5 points PnP problem, the resulting pose is left in iWarmRotation and iWarmTranslation.
+    /// While tracking continuously our vertices are matched in the same order every frame,
+    /// we then only refine last frame's pose with a few Levenberg-Marquardt iterations.
+    /// We fall back to a full solve when that refinement does not fit our points as well as our last full solve did.
+    ///
+    bool Tracker::SolvePnp()
+    {
+        if (iWarmStart)
+        {
+            const cv::Vec3d rotation = iWarmRotation;
+            const cv::Vec3d translation = iWarmTranslation;
+            cv::solvePnPRefineLM(iModel, iTrackedPoints, iCameraMatrix, iDistCoeffsMatrix, iWarmRotation, iWarmTranslation,
+                                 cv::TermCriteria(cv::TermCriteria::COUNT + cv::TermCriteria::EPS, KRefineIterations, FLT_EPSILON));
+            if (ReprojectionError() <= iColdSolveError * 2 + KRefineMaxErrorSlack)
+            {
+                return true;
+            }
+
+            dbgout << "Refinement rejected\n";
+            iWarmRotation = rotation;
+            iWarmTranslation = translation;
+        }
+
+        // Guess extrinsic boolean is only for ITERATIVE method, it will be ignored by all other methods.
+        // Seed it with our last pose if we have one, zero otherwise.
+        if (!iWarmStart)
+        {
+            iWarmRotation = cv::Vec3d::all(0);
+            iWarmTranslation = cv::Vec3d::all(0);
+        }
+
+        iWarmStart = cv::solvePnP(iModel, iTrackedPoints, iCameraMatrix, iDistCoeffsMatrix, iWarmRotation, iWarmTranslation, true, iSolver);
+        if (iWarmStart)
+        {
+            iColdSolveError = ReprojectionError();
+        }
+
+        return iWarmStart;
+    }
+
+    ///
+    /// Root mean square distance in pixels between our tracked points and our model projected using our current pose.
+    ///
+    double Tracker::ReprojectionError()
+    {
+        cv::projectPoints(iModel, iWarmRotation, iWarmTranslation, iCameraMatrix, iDistCoeffsMatrix, iReprojectedPoints);
+        double sum = 0;
+        for (size_t i = 0; i < iTrackedPoints.size(); i++)
+        {
+            const cv::Point2f delta = iReprojectedPoints[i] - iTrackedPoints[i];
+            sum += delta.dot(delta);
+        }
+
+        return std::sqrt(sum / iTrackedPoints.size());
+    }
+
     ///
     ///
     void Tracker::ProcessFrame()
@@ -428,6 +485,11 @@ namespace EasyTracker
         
 
         const bool success = iPoints.size() >= iModel.size() && iModel.size() >= KMinVertexCount;
+        if (!success)
+        {
+            // Lost our points, next solve starts from scratch
+            iWarmStart = false;
+        }
 
         int topPointIndex = -1;
         int rightPointIndex = -1;
@@ -440,6 +502,8 @@ namespace EasyTracker
         {
             // Lets match our 3D vertices with our image 2D points
             MatchVertices(topPointIndex, rightPointIndex, leftPointIndex, centerPointIndex, topRightPointIndex, topLeftPointIndex);
+            // Next frame, only look for our points around where we found them
+            iPointExtractor.SetRoi(iTrackedPoints, iMatFrame.size());
 
             bool movedEnough = true;
             // Check if we moved enough since last time we were here
@@ -491,22 +555,13 @@ namespace EasyTracker
                 }
                 else
                 {
-                    //Guess extrinsic boolean is only for ITERATIVE method, it will be set to false for all other method
-                    cv::Mat rotation, translation;
-                    // Init only needed for iterative, it's also useless as it is
-                    rotation = cv::Mat::zeros(3, 1, CV_64FC1);
-                    translation = cv::Mat::zeros(3, 1, CV_64FC1);
-                    rotation.setTo(cv::Scalar(0));
-                    translation.setTo(cv::Scalar(0));
-                    /////
                     iRotations.clear();
                     iTranslations.clear();
-                    bool solved = cv::solvePnP(iModel, iTrackedPoints, iCameraMatrix, iDistCoeffsMatrix, rotation, translation, true, iSolver );
-                    if (solved)
+                    if (SolvePnp())
                     {
                         solutionCount = 1;
-                        iRotations.push_back(rotation);
-                        iTranslations.push_back(translation);
+                        iRotations.push_back(cv::Mat(iWarmRotation));
+                        iTranslations.push_back(cv::Mat(iWarmTranslation));
                     }
                 }
 
@@ -525,7 +580,7 @@ namespace EasyTracker
                         dbgout << "\n";
                         dbgout << "Rotation:\n";
                         //dbgout << rvecs.at(i);
-                        cv::Mat rotationCameraMatrix;
+                        cv::Matx33d rotationCameraMatrix;
                         cv::Rodrigues(iRotations[i], rotationCameraMatrix);
                         cv::Vec3d angles;
                         getEulerAngles(rotationCameraMatrix, angles);
@@ -563,6 +618,8 @@ namespace EasyTracker
                     {
                         infout << "WARNING: discarding solution!";
                         iBadSolutionCount++;
+                        // Don't refine from a pose we rejected
+                        iWarmStart = false;
                     }
                     else
                     {
@@ -665,51 +722,53 @@ namespace EasyTracker
     }
 
     ///
+    /// Process every frame as soon as the camera hands it over, get_frame() blocks until then.
     ///
-    ///
-    void Tracker::Tick()
+    void Tracker::run()
     {
-        if (CheckCamera())
-        {
-            // Camera was just started, skipping that frame as it was causing a deadlock on our process mutex in ProcessFrame
-            // In fact it looked like ProcessFrame was called twice without completing.
-            // That has something to do with the ticker interval being changed after the camera is started.
-            return;
-        }
-      
-        iTimer.start();
+        portable::set_curthread_name("tracker/easy");
 
-        bool new_frame = false;
+        iFpsTimer.start(); // Kick off our FPS counter
+
+        while (!isInterruptionRequested())
         {
-            QMutexLocker l(&camera_mtx);
+            CheckCamera();
+
+            iTimer.start();
 
-            if (camera)
+            bool new_frame = false, open = false;
             {
-                std::tie(iFrame, new_frame) = camera->get_frame();
+                QMutexLocker l(&camera_mtx);
+
+                open = camera->is_open();
+                if (open)
+                {
+                    std::tie(iFrame, new_frame) = camera->get_frame();
+                }
             }
-                    
-        }
 
-        if (new_frame)
-        {
-            ProcessFrame();
-        }
-        else
-        {
-            iSkippedFrameCount++;
-        }
+            if (new_frame)
+            {
+                ProcessFrame();
+            }
+            else
+            {
+                iSkippedFrameCount++;
+                // Don't spin on a camera that failed to start or doesn't block
+                portable::sleep(open ? 1 : 100);
+            }
 
-        // Compute FPS
-        double elapsed = iFpsTimer.elapsed_seconds();
-        if (elapsed >= 1.0)
-        {
-            iFps = iFrameCount / elapsed;
-            iSkippedFps = iSkippedFrameCount / elapsed;
-            iFrameCount = 0;
-            iSkippedFrameCount = 0;
-            iFpsTimer.start();
+            // Compute FPS
+            double elapsed = iFpsTimer.elapsed_seconds();
+            if (elapsed >= 1.0)
+            {
+                iFps = iFrameCount / elapsed;
+                iSkippedFps = iSkippedFrameCount / elapsed;
+                iFrameCount = 0;
+                iSkippedFrameCount = 0;
+                iFpsTimer.start();
+            }
         }
-        
     }
 
     /// @return True if camera was just started, false otherwise.
@@ -725,10 +784,15 @@ namespace EasyTracker
         iCameraInfo.fps = iSettings.cam_fps;
         iCameraInfo.width = iSettings.cam_res_x;
         iCameraInfo.height = iSettings.cam_res_y;
+        // Point extraction only runs on single channel frames anyway
+        iCameraInfo.accept_luma = true;
 
         bool res = camera->start(iCameraInfo);
         //portable::sleep(5000);
 
+        // Our last points are meaningless with a new camera or resolution
+        iPointExtractor.ResetRoi();
+
         // We got our camera intrinsics, create corresponding matrices
         CreateCameraIntrinsicsMatrices();
 
@@ -745,7 +809,6 @@ namespace EasyTracker
 
     }
 
-    // Calling this from another thread than the one it belongs too after it's started somehow breaks our timer
     void Tracker::SetFps(int aFps)
     {
         QMutexLocker l(&camera_mtx);
@@ -754,16 +817,9 @@ namespace EasyTracker
 
     void Tracker::DoSetFps(int aFps)
     {
-        // Aplly FPS to timer
-        iTicker.setInterval(1000 / aFps + 1);
-
         // Reset Kalman filter
-        //int nStates = 18;            // the number of states
-        //int nMeasurements = 6;       // the number of measured states
-        //int nInputs = 0;             // the number of control actions
-        //double dt = 0.125;           // time between measurements (1/FPS)
-        double dt = 1000.0 / aFps;
-        iKf.Init(18, 6, 0, dt);
+        double dt = 1000.0 / aFps;     // time between measurements (1/FPS)
+        iKf.Init(dt);
     }
 
 
@@ -775,6 +831,8 @@ namespace EasyTracker
         infout << "Update model - begin";
 
         QMutexLocker lock(&iProcessLock);
+        // Last pose does not match our new model
+        iWarmStart = false;
         // Construct the points defining the object we want to detect based on settings.
         // We are converting them from millimeters to centimeters.
         // TODO: Need to support clip too. That's cap only for now.
@@ -816,6 +874,7 @@ namespace EasyTracker
         QMutexLocker l(&iProcessLock);
         iPointExtractor.UpdateSettings();
         iSolver = iSettings.PnpSolver;
+        iWarmStart = false;
         iDeadzoneHalfEdge = iSettings.DeadzoneRectHalfEdgeSize;
         iDeadzoneEdge = iDeadzoneHalfEdge * 2;
         iTrackedRects.clear();
@@ -833,7 +892,7 @@ namespace EasyTracker
         }
 
         // Create our camera
-        camera = video::make_camera(iSettings.camera_name);
+        camera = video::make_camera(video::resolve_camera_name(iSettings.camera_name, iSettings.camera_id));
 
         if (!camera)
             return error(QStringLiteral("Can't open camera %1").arg(iSettings.camera_name));
@@ -847,18 +906,9 @@ namespace EasyTracker
         //video_widget->resize(video_frame->width(), video_frame->height());
         video_frame->show();
 
-        // Precise timer is needed otherwise the interval is not really respected
-        iTicker.setTimerType(Qt::PreciseTimer);
         SetFps(iSettings.cam_fps);
-        iTicker.moveToThread(&iThread);
-        // Connect timer timeout signal to our tick slot
-        connect(&iTicker, SIGNAL(timeout()), SLOT(Tick()), Qt::DirectConnection);
-        // Start our timer once our thread is started
-        iTicker.connect(&iThread, SIGNAL(started()), SLOT(start()));
-        iFpsTimer.start(); // Kick off our FPS counter
-        iThread.setObjectName("EasyTrackerThread");
-        iThread.setPriority(QThread::HighPriority); // Do we really want that?
-        iThread.start();
+        setObjectName("EasyTrackerThread");
+        start(QThread::HighPriority); // Do we really want that?
 
         return {};
     }
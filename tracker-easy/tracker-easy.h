@@ -52,7 +52,7 @@ namespace EasyTracker
 
     using namespace numeric_types;
 
-    struct Tracker : public QObject, ITracker
+    struct Tracker : QThread, ITracker
     {
         Q_OBJECT
     public:        
@@ -66,14 +66,15 @@ namespace EasyTracker
         void data(double* data) override;
         bool center() override;
 
-    private slots:
-        void Tick();
-
+    protected:
+        void run() override;
 
     private:
         void UpdateModel();
         void CreateCameraIntrinsicsMatrices();
         void ProcessFrame();        
+        bool SolvePnp();
+        double ReprojectionError();
         void MatchVertices(int& aTopIndex, int& aRightIndex, int& aLeftIndex, int& aCenterIndex, int& aTopRight, int& aTopLeft);
         void MatchThreeOrFourVertices(int& aTopIndex, int& aRightIndex, int& aLeftIndex, int& aCenterIndex);
         void MatchFiveVertices(int& aTopIndex, int& aRightIndex, int& aLeftIndex, int& aTopRight, int& aTopLeft);
@@ -89,8 +90,6 @@ namespace EasyTracker
         void UpdateSettings();
 
         QMutex camera_mtx;
-        QThread iThread;
-        QTimer iTicker;
 
         Settings iSettings;
 
@@ -151,6 +150,14 @@ namespace EasyTracker
         std::vector<cv::Mat> iRotations;
         // Angle solutions, pitch, yaw, roll, in this order
         std::vector<cv::Vec3d> iAngles;
+        // Last pose solving our 4 or 5 points model, used to warm start our solver
+        cv::Vec3d iWarmRotation;
+        cv::Vec3d iWarmTranslation;
+        bool iWarmStart = false;
+        // Reprojection error in pixels of our last full solve
+        double iColdSolveError = 0;
+        // Model projected using our current pose
+        std::vector<cv::Point2f> iReprojectedPoints;
         // The index of our best solution in the above arrays
         int iBestSolutionIndex = -1;
         // Best translation
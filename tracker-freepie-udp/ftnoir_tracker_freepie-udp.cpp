@@ -6,9 +6,7 @@
 #include <algorithm>
 #include <cmath>
 
-tracker_freepie::tracker_freepie() : pose { 0,0,0, 0,0,0 }
-{
-}
+tracker_freepie::tracker_freepie() = default;
 
 tracker_freepie::~tracker_freepie()
 {
@@ -34,10 +32,27 @@ void tracker_freepie::run() {
         Mask = flag_Raw | flag_Orient
     };
 
+    // only bounds how long interruption takes on an idle socket
+    constexpr int wait_timeout_ms = 100;
+
+    constexpr int add_cbx[] =
+    {
+        0,
+        90,
+        -90,
+        180,
+        -180,
+    };
+
+    constexpr double r2d = 180 / M_PI;
+
     sock.bind(QHostAddress::Any, (unsigned short) s.port, QUdpSocket::ShareAddress | QUdpSocket::ReuseAddressHint);
 
     while (!isInterruptionRequested())
     {
+        if (!sock.hasPendingDatagrams() && !sock.waitForReadyRead(wait_timeout_ms))
+            continue;
+
         int order[] =
         {
             clamp(s.idx_x, 0, 2),
@@ -45,53 +60,31 @@ void tracker_freepie::run() {
             clamp(s.idx_z, 0, 2)
         };
 
-        double orient[3] = {0, 0, 0};
-        bool filled = false;
+        int add_indices[] = { s.add_yaw, s.add_pitch, s.add_roll };
 
         while (sock.hasPendingDatagrams())
         {
-            using t = decltype(data);
-            t tmp {};
-            (void) sock.readDatagram(reinterpret_cast<char*>(&tmp), sizeof(data));
+            data = {};
+            (void) sock.readDatagram(reinterpret_cast<char*>(&data), sizeof(data));
 
-            int flags = tmp.flags & F::Mask;
+            double orient[3];
+            int flags = data.flags & F::Mask;
 
             switch (flags)
             {
-            //default:
-            case flag_Raw:
-            continue;
             case flag_Raw | flag_Orient:
                 for (int i = 0; i < 3; i++)
-                    orient[i] = (double)tmp.fl[i+9];
+                    orient[i] = (double)data.fl[i+9];
             break;
             case flag_Orient:
                 for (int i = 0; i < 3; i++)
-                    orient[i] = (double)tmp.fl[i];
+                    orient[i] = (double)data.fl[i];
             break;
-            default: goto fail;
+            default:
+                continue;
             }
 
-            filled = true;
-            data = tmp;
-        }
-
-        if (filled)
-        {
-            constexpr int add_cbx[] =
-            {
-                0,
-                90,
-                -90,
-                180,
-                -180,
-            };
-
-            int add_indices[] = { s.add_yaw, s.add_pitch, s.add_roll };
-
-            QMutexLocker foo(&mtx);
-
-            constexpr double r2d = 180 / M_PI;
+            double angles[3];
 
             for (int i = 0; i < 3; i++)
             {
@@ -100,29 +93,25 @@ void tracker_freepie::run() {
                 int add = 0;
                 if (add_idx >= 0 && add_idx < (int)std::size(add_cbx))
                     add = add_cbx[add_idx];
-                pose[Yaw + i] = r2d * orient[axis] + add;
+                angles[i] = r2d * orient[axis] + add;
             }
+
+            pose.store(angles);
         }
-fail:
-        usleep(4000);
     }
 }
 
 module_status tracker_freepie::start_tracker(QFrame*)
 {
-    start();
     sock.moveToThread(this);
+    start();
 
     return status_ok();
 }
 
 void tracker_freepie::data(double *data)
 {
-    QMutexLocker foo(&mtx);
-
-    data[Yaw] = pose[Yaw];
-    data[Pitch] = pose[Pitch];
-    data[Roll] = pose[Roll];
+    pose.load(data + Yaw);
 }
 
 OPENTRACK_DECLARE_TRACKER(tracker_freepie, dialog_freepie, meta_freepie)
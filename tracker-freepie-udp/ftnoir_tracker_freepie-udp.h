@@ -11,6 +11,7 @@
 #include "ui_freepie-udp-controls.h"
 #include "api/plugin-api.hpp"
 #include "options/options.hpp"
+#include "compat/seqlock.hpp"
 using namespace options;
 
 struct settings : opts {
@@ -38,10 +39,10 @@ public:
 protected:
     void run() override;
 private:
-    double pose[6];
+    // yaw, pitch, roll; written by run() and read by data()
+    seqlock_slot<3> pose;
     QUdpSocket sock;
     settings s;
-    QMutex mtx;
 };
 
 class dialog_freepie : public ITrackerDialog
@@ -7,7 +7,12 @@
 #include "ftnoir_tracker_linux_joystick.h"
 #include "api/plugin-api.hpp"
 #include "compat/math.hpp"
-#include <QMutexLocker>
+#include "compat/thread-name.hpp"
+
+#include <cerrno>
+#include <poll.h>
+
+#include <QDebug>
 
 joystick::joystick()
 {
@@ -17,15 +22,63 @@ joystick::joystick()
 
 
 joystick::~joystick() {
-    if (joy_fd > 0) close(joy_fd);
+    requestInterruption();
+    wait();
+    if (joy_fd != -1) close(joy_fd);
 }
 
 module_status joystick::start_tracker(QFrame *)
 {
     if (joy_fd == -1) return error("Couldn't open joystick");
+    start(QThread::HighPriority);
     return status_ok();
 }
 
+void joystick::run()
+{
+    portable::set_curthread_name("tracker/joystick");
+
+    // short enough for the destructor not to wait on an idle stick
+    constexpr int poll_timeout_ms = 100;
+    js_event events[64];
+
+    while (!isInterruptionRequested())
+    {
+        pollfd pfd { joy_fd, POLLIN, 0 };
+        int ret = poll(&pfd, 1, poll_timeout_ms);
+
+        if (ret == -1 && errno != EINTR)
+        {
+            qDebug() << "joystick: poll" << errno;
+            break;
+        }
+        if (ret <= 0)
+            continue;
+        if (pfd.revents & (POLLERR | POLLHUP | POLLNVAL))
+        {
+            qDebug() << "joystick: device gone";
+            break;
+        }
+
+        // drain everything queued since the last wakeup, only the latest value per axis matters
+        for (;;)
+        {
+            ssize_t sz = read(joy_fd, events, sizeof(events));
+            if (sz <= 0)
+                break;
+
+            for (unsigned i = 0; i < sz / sizeof(*events); i++)
+            {
+                const js_event& event = events[i];
+                /* Initial axis state is sent with JS_EVENT_INIT set, ignore buttons. */
+                if ((event.type & ~JS_EVENT_INIT) != JS_EVENT_AXIS || event.number >= AXIS_COUNT)
+                    continue;
+                axes_state[event.number].store(event.value, std::memory_order_relaxed);
+            }
+        }
+    }
+}
+
 
 void joystick::data(double *data)
 {
@@ -47,40 +100,14 @@ void joystick::data(double *data)
         180
     };
 
-    const QString guid = s.guid;
-    int axes[8];
-    struct js_event event;
-    bool ret = true;
-    if (read(joy_fd, &event, sizeof(event)) > 0)
-    {
-        switch (event.type)
-        {
-        case JS_EVENT_AXIS:
-            if (event.number >= 8) break;
-            axes_state[event.number] = event.value;
-
-            break;
-        default:
-            /* Ignore init/button events. */
-            break;
-        }
-    }
-
     for (int i = 0; i < 6; i++)
     {
-        axes[i] = axes_state[i];
-    }
-    if (ret)
-    {
-        for (int i = 0; i < 6; i++)
-        {
-            int k = map[i];
-            if (k < 0 || k >= 8)
-                data[i] = 0;
-            else
-                data[i] = clamp(axes[k] * limits[i] / AXIS_MAX,
-                                -limits[i], limits[i]);
-        }
+        int k = map[i];
+        if (k < 0 || k >= AXIS_COUNT)
+            data[i] = 0;
+        else
+            data[i] = clamp(axes_state[k].load(std::memory_order_relaxed) * limits[i] / AXIS_MAX,
+                            -limits[i], limits[i]);
     }
 }
 
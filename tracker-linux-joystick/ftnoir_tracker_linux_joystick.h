@@ -14,6 +14,8 @@
 #include <QList>
 #include <QFrame>
 #include <QStringList>
+#include <QThread>
+#include <atomic>
 #include <cmath>
 #include "api/plugin-api.hpp"
 
@@ -47,18 +49,23 @@ struct linux_joystick {
 QList<linux_joystick> getJoysticks();
 QString getJoystickDevice(QString guid);
 
-class joystick : public ITracker
+class joystick : protected virtual QThread, public ITracker
 {
 public:
     joystick();
-    ~joystick();
-    module_status start_tracker(QFrame *);
-    void data(double *data);
+    ~joystick() override;
+    module_status start_tracker(QFrame *) override;
+    void data(double *data) override;
     settings s;
     QString guid;
     static constexpr int AXIS_MAX = USHRT_MAX;
-    int axes_state[6] = {0};
+    static constexpr int AXIS_COUNT = 8;
+    // written by the reader thread only, data() copies the latest values
+    std::atomic<int> axes_state[AXIS_COUNT] {};
     int joy_fd;
+
+protected:
+    void run() override;
 };
 
 class dialog_joystick: public ITrackerDialog
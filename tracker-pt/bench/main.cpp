@@ -0,0 +1,341 @@
+// Compares the POSIT and P3P pose solvers on the same input, reporting the
+// error against ground truth and the time spent in PointTracker::track().
+//
+// synthetic: projects the model from the "tracker-pt" settings along the
+//   video-synthetic camera's trajectory, optionally adding pixel noise.
+// replay: runs the point extractor over a recording made with OTR_RECORD_VIDEO.
+//   Given the video-synthetic camera's ground truth CSV for the same session,
+//   rows are matched to recorded frames by frame number.
+
+#include "point_tracker.h"
+#include "module/point_extractor.h"
+#include "module/frame.hpp"
+#include "video/recording.hpp"
+#include "compat/timer.hpp"
+#include "compat/math-imports.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QString>
+#include <QStringList>
+
+using namespace numeric_types;
+
+namespace {
+
+struct pose final
+{
+    cv::Matx33d R;
+    cv::Vec3d T;
+};
+
+struct stats final
+{
+    std::vector<double> solve_us, rot_err, pos_err;
+    unsigned lost = 0;
+
+    void print(const char* name) const;
+};
+
+struct solver final
+{
+    const char* name;
+    pt_pose_solver type;
+    PointTracker tracker;
+    stats st;
+};
+
+double percentile(std::vector<double> xs, double p)
+{
+    if (xs.empty())
+        return 0;
+    std::sort(xs.begin(), xs.end());
+    return xs[std::min(xs.size() - 1, std::size_t(p * (xs.size() - 1) + .5))];
+}
+
+double mean(const std::vector<double>& xs)
+{
+    double sum = 0;
+    for (double x : xs)
+        sum += x;
+    return xs.empty() ? 0 : sum / xs.size();
+}
+
+void stats::print(const char* name) const
+{
+    std::printf("%-6s solve us: mean %7.2f  median %7.2f  p99 %7.2f  max %7.2f  (%u frames)\n",
+                name, mean(solve_us), percentile(solve_us, .5), percentile(solve_us, .99),
+                percentile(solve_us, 1), (unsigned)solve_us.size());
+    if (!rot_err.empty())
+        std::printf("%-6s rot deg:  mean %7.3f  median %7.3f  p99 %7.3f  max %7.3f\n"
+                    "%-6s pos mm:   mean %7.3f  median %7.3f  p99 %7.3f  max %7.3f\n",
+                    name, mean(rot_err), percentile(rot_err, .5), percentile(rot_err, .99), percentile(rot_err, 1),
+                    name, mean(pos_err), percentile(pos_err, .5), percentile(pos_err, .99), percentile(pos_err, 1));
+    if (lost)
+        std::printf("%-6s %u frames without a pose\n", name, lost);
+}
+
+double rotation_error(const cv::Matx33d& R1, const cv::Matx33d& R2)
+{
+    const double c = (cv::trace(R1.t() * R2) - 1) * .5;
+    return acos(std::clamp(c, -1., 1.)) * 180 / M_PI;
+}
+
+pose to_pose(const Affine& X)
+{
+    pose ret;
+    for (int i = 0; i < 3; i++)
+    {
+        for (int j = 0; j < 3; j++)
+            ret.R(i, j) = (double)X.R(i, j);
+        ret.T[i] = (double)X.t[i];
+    }
+    return ret;
+}
+
+// same as the video-synthetic camera's defaults
+pose trajectory(double time)
+{
+    constexpr double distance = 600, yaw_amplitude = 30, pitch_amplitude = 15, period = 8;
+    constexpr double deg = M_PI / 180;
+
+    const double phase = 2 * M_PI * time / period;
+    const double yaw = yaw_amplitude * deg * sin(phase);
+    const double pitch = pitch_amplitude * deg * sin(phase / 1.3);
+    const double roll = 5 * deg * sin(phase / 1.7);
+
+    const double cy = cos(yaw), sy = sin(yaw);
+    const double cp = cos(pitch), sp = sin(pitch);
+    const double cr = cos(roll), sr = sin(roll);
+
+    const cv::Matx33d Ry(cy, 0, sy,
+                         0, 1, 0,
+                         -sy, 0, cy);
+    const cv::Matx33d Rx(1, 0, 0,
+                         0, cp, -sp,
+                         0, sp, cp);
+    const cv::Matx33d Rz(cr, -sr, 0,
+                         sr, cr, 0,
+                         0, 0, 1);
+
+    return { Ry * Rx * Rz,
+             { 40 * sin(phase / 1.1), 25 * sin(phase / .9), distance + 50 * sin(phase / 1.5) } };
+}
+
+void track(solver& s, const std::vector<vec2>& points, const PointModel& model,
+           const pt_camera_info& info, int init_phase_timeout)
+{
+    Timer t;
+    s.tracker.track(points, model, info, init_phase_timeout, s.type);
+    s.st.solve_us.push_back(t.elapsed_ms() * 1000);
+}
+
+void compare(solver& s, const pose& gt)
+{
+    const pose X = to_pose(s.tracker.pose());
+
+    if (X.T[2] <= 0)
+    {
+        s.st.lost++;
+        return;
+    }
+
+    s.st.rot_err.push_back(rotation_error(X.R, gt.R));
+    s.st.pos_err.push_back(cv::norm(X.T - gt.T));
+}
+
+int run_synthetic(const pt_settings& s, solver (&solvers)[2], unsigned frames, double noise_px)
+{
+    const PointModel model(s);
+    const int w = s.cam_res_x, h = s.cam_res_y;
+
+    pt_camera_info info;
+    info.fov = s.fov;
+    info.res_x = w;
+    info.res_y = h;
+
+    const double focal_length = (double)pt_camera_info::get_focal_length(info.fov, w, h) * w;
+    const cv::Vec3d points_M[] {
+        { 0, 0, 0 },
+        { (double)model.M01[0], (double)model.M01[1], (double)model.M01[2] },
+        { (double)model.M02[0], (double)model.M02[1], (double)model.M02[2] },
+    };
+
+    std::mt19937 rng{42};
+    std::normal_distribution<double> noise{0, std::max(1e-9, noise_px)};
+    std::vector<vec2> points;
+
+    for (unsigned i = 0; i < frames; i++)
+    {
+        const pose gt = trajectory(i / 60.);
+
+        points.clear();
+        for (const cv::Vec3d& p : points_M)
+        {
+            const cv::Vec3d v = gt.R * p + gt.T;
+            double px = (w * .5 + focal_length * v[0] / v[2]) * (w - 1) / w;
+            double py = (h * .5 - focal_length * v[1] / v[2]) * (h - 1) / h;
+            if (noise_px > 0)
+                px += noise(rng), py += noise(rng);
+            auto [ x, y ] = pt_pixel_pos_mixin::to_screen_pos((f)px, (f)py, w, h);
+            points.emplace_back(x, y);
+        }
+
+        for (solver& k : solvers)
+        {
+            track(k, points, model, info, *s.dynamic_pose ? *s.init_phase_timeout : 0);
+            compare(k, gt);
+        }
+    }
+
+    return 0;
+}
+
+bool read_ground_truth(const QString& filename, std::unordered_map<unsigned, pose>& ret)
+{
+    QFile file(filename);
+    if (!file.open(QFile::ReadOnly | QFile::Text))
+    {
+        std::fprintf(stderr, "can't open ground truth '%s'\n", qPrintable(filename));
+        return false;
+    }
+
+    // frame,time,r00..r22,tx,ty,tz
+    (void)file.readLine();
+
+    while (!file.atEnd())
+    {
+        const QStringList cols = QString::fromUtf8(file.readLine()).trimmed().split(',');
+        if (cols.size() != 14)
+            continue;
+
+        pose p;
+        for (int i = 0; i < 9; i++)
+            p.R(i / 3, i % 3) = cols[2 + i].toDouble();
+        for (int i = 0; i < 3; i++)
+            p.T[i] = cols[11 + i].toDouble();
+
+        ret[cols[0].toUInt()] = p;
+    }
+
+    return true;
+}
+
+int run_replay(const pt_settings& s, solver (&solvers)[2], const QString& filename, const QString& gt_filename)
+{
+    video::recording::reader rec;
+    if (!rec.open(filename))
+    {
+        std::fprintf(stderr, "can't open recording '%s'\n", qPrintable(filename));
+        return EXIT_FAILURE;
+    }
+
+    std::unordered_map<unsigned, pose> ground_truth;
+    if (!gt_filename.isEmpty() && !read_ground_truth(gt_filename, ground_truth))
+        return EXIT_FAILURE;
+
+    const PointModel model(s);
+    pt_module::PointExtractor extractor{"tracker-pt"};
+    pt_module::Frame frame;
+    pt_module::Preview preview{320, 240};
+    std::vector<vec2> points;
+    std::vector<double> disagreement_rot, disagreement_pos;
+    unsigned too_few_points = 0;
+
+    for (unsigned i = 0; i < rec.frame_count(); i++)
+    {
+        video::frame fr;
+        std::uint64_t timestamp_ns;
+
+        if (!rec.get(i, fr, timestamp_ns))
+            continue;
+
+        int stride = fr.stride;
+        if (stride == 0)
+            stride = cv::Mat::AUTO_STEP;
+        frame.mat = cv::Mat(fr.height, fr.width, CV_8UC(fr.channels), (void*)fr.data, stride);
+
+        extractor.extract_points(frame, preview, points);
+
+        if (points.size() < PointModel::N_POINTS)
+        {
+            too_few_points++;
+            continue;
+        }
+
+        pt_camera_info info;
+        info.fov = s.fov;
+        info.res_x = fr.width;
+        info.res_y = fr.height;
+
+        for (solver& k : solvers)
+            track(k, points, model, info, *s.dynamic_pose ? *s.init_phase_timeout : 0);
+
+        if (auto it = ground_truth.find(i); it != ground_truth.end())
+            for (solver& k : solvers)
+                compare(k, it->second);
+
+        const pose a = to_pose(solvers[0].tracker.pose()), b = to_pose(solvers[1].tracker.pose());
+        disagreement_rot.push_back(rotation_error(a.R, b.R));
+        disagreement_pos.push_back(cv::norm(a.T - b.T));
+    }
+
+    std::printf("%u frames, %u with fewer than %u points\n",
+                rec.frame_count(), too_few_points, PointModel::N_POINTS);
+    std::printf("POSIT vs P3P: rot deg mean %.3f max %.3f, pos mm mean %.3f max %.3f\n",
+                mean(disagreement_rot), percentile(disagreement_rot, 1),
+                mean(disagreement_pos), percentile(disagreement_pos, 1));
+
+    return 0;
+}
+
+} // ns
+
+int main(int argc, char** argv)
+{
+    QCoreApplication app(argc, argv);
+    const QStringList args = app.arguments();
+
+    if (args.size() < 2 || (args[1] != "synthetic" && args[1] != "replay") ||
+        (args[1] == "replay" && args.size() < 3))
+    {
+        std::fprintf(stderr,
+                     "usage: %s synthetic [frames] [noise-px]\n"
+                     "       %s replay <recording> [ground-truth.csv]\n"
+                     "model, field of view and resolution come from the current profile's PT settings\n",
+                     argv[0], argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    const pt_settings s{"tracker-pt"};
+
+    solver solvers[2] {
+        { "POSIT", pt_solver_posit, {}, {} },
+        { "P3P", pt_solver_p3p, {}, {} },
+    };
+
+    int ret;
+
+    if (args[1] == "synthetic")
+    {
+        const unsigned frames = args.size() > 2 ? args[2].toUInt() : 10000;
+        const double noise_px = args.size() > 3 ? args[3].toDouble() : 0;
+        ret = run_synthetic(s, solvers, frames, noise_px);
+    }
+    else
+        ret = run_replay(s, solvers, args[2], args.size() > 3 ? args[3] : QString());
+
+    if (ret == 0)
+        for (const solver& k : solvers)
+            k.st.print(k.name);
+
+    return ret;
+}
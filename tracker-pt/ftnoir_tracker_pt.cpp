@@ -10,9 +10,14 @@
 #include "pt-api.hpp"
 #include "cv/init.hpp"
 #include "video/video-widget.hpp"
+#include "video/camera.hpp"
+#include "compat/math.hpp"
 #include "compat/math-imports.hpp"
 #include "compat/check-visible.hpp"
 #include "compat/thread-name.hpp"
+#include "compat/sleep.hpp"
+
+#include <algorithm>
 
 #include <QHBoxLayout>
 #include <QDebug>
@@ -59,11 +64,20 @@ void Tracker_PT::run()
     while(!isInterruptionRequested())
     {
         pt_camera_info info;
-        bool new_frame = false;
+        bool new_frame = false, camera_open = true;
 
         {
             QMutexLocker l(&camera_mtx);
             std::tie(new_frame, info) = camera->get_frame(*frame);
+            camera_open = camera->is_open();
+        }
+
+        // the camera went away, e.g. it was unplugged; wait for it to come back
+        if (!camera_open)
+        {
+            portable::sleep(reopen_interval_ms);
+            (void)maybe_reopen_camera();
+            continue;
         }
 
         if (new_frame)
@@ -90,7 +104,8 @@ void Tracker_PT::run()
                     point_tracker.track(points,
                                         PointModel(s),
                                         info,
-                                        dynamic_pose_ms);
+                                        dynamic_pose_ms,
+                                        s.pose_solver);
                     ever_success.store(true, std::memory_order_relaxed);
                 }
 
@@ -98,6 +113,11 @@ void Tracker_PT::run()
                 X_CM = point_tracker.pose();
             }
 
+            // samples are dropped when the dialog falls behind,
+            // it gets plenty of them anyway
+            if (success && calibrating.load(std::memory_order_relaxed))
+                (void)calib_samples.push(X_CM);
+
             if (preview_visible)
             {
                 const f fx = pt_camera_info::get_focal_length(info.fov, info.res_x, info.res_y);
@@ -117,16 +137,92 @@ void Tracker_PT::run()
                     preview_frame = traits->make_preview(w, h);
                 }
             }
+
+            update_roi(info, success);
         }
     }
 }
 
+void Tracker_PT::update_roi(const pt_camera_info& info, bool success)
+{
+    QMutexLocker l(&camera_mtx);
+
+    const int W = info.res_x, H = info.res_y;
+
+    // lost the points or cropping got turned off, back to the full field of view
+    if (!*s.camera_roi || !roi_supported || !success || W <= 0 || H <= 0)
+    {
+        if (!roi.empty())
+        {
+            roi = {};
+            (void)camera->set_roi(0, 0, 0, 0);
+        }
+        return;
+    }
+
+    // the brightest points, the rest are likely reflections
+    f x0 = W, y0 = H, x1 = 0, y1 = 0;
+    for (unsigned k = 0; k < PointModel::N_POINTS && k < points.size(); k++)
+    {
+        auto [ x, y ] = pt_pixel_pos_mixin::to_pixel_pos(points[k][0], points[k][1], W, H);
+        x0 = std::fmin(x0, x); x1 = std::fmax(x1, x);
+        y0 = std::fmin(y0, y); y1 = std::fmax(y1, y);
+    }
+
+    // leave room for the head to move until the next frame
+    const int margin = std::max(roi_margin_px, iround(std::fmax(x1 - x0, y1 - y0)));
+    const cv::Rect want(iround(x0) - margin, iround(y0) - margin,
+                        iround(x1 - x0) + 2 * margin, iround(y1 - y0) + 2 * margin);
+
+    if (!roi.empty() && (roi & want) == want)
+        return;
+
+    // same size windows only move the crop, bigger or smaller ones restart the stream
+    cv::Size size = roi.size();
+    if (roi.empty() || size.width < want.width || size.height < want.height ||
+        size.width > 2 * want.width || size.height > 2 * want.height)
+    {
+        size.width = (want.width + roi_margin_px + roi_align_px - 1) / roi_align_px * roi_align_px;
+        size.height = (want.height + roi_margin_px + roi_align_px - 1) / roi_align_px * roi_align_px;
+    }
+
+    cv::Rect next;
+
+    // not worth it for a window close to the full field of view
+    if (size.area() * 4 < W * H * 3)
+    {
+        next.width = std::min(size.width, W);
+        next.height = std::min(size.height, H);
+        next.x = std::clamp(want.x + want.width / 2 - next.width / 2, 0, W - next.width);
+        next.y = std::clamp(want.y + want.height / 2 - next.height / 2, 0, H - next.height);
+    }
+
+    if (next == roi)
+        return;
+
+    if (camera->set_roi(next.x, next.y, next.width, next.height))
+        roi = next;
+    else
+    {
+        // the camera can't crop, or not like this; stop asking until it's reopened
+        roi = {};
+        roi_supported = false;
+    }
+}
+
 bool Tracker_PT::maybe_reopen_camera()
 {
     QMutexLocker l(&camera_mtx);
 
-    return camera->start(s.camera_name,
-                         s.cam_fps, s.cam_res_x, s.cam_res_y);
+    // either restarted at the full field of view, or kept as it was
+    if (!camera->start(video::resolve_camera_name(s.camera_name, s.camera_id),
+                       s.cam_fps, s.cam_res_x, s.cam_res_y))
+        return false;
+
+    roi_supported = true;
+    roi = {};
+    (void)camera->set_roi(0, 0, 0, 0);
+    return true;
 }
 
 void Tracker_PT::set_fov(int value)
@@ -225,4 +321,14 @@ Affine Tracker_PT::pose() const
     return point_tracker.pose();
 }
 
+void Tracker_PT::set_calibrating(bool x)
+{
+    calibrating.store(x, std::memory_order_relaxed);
+}
+
+bool Tracker_PT::pop_calibration_sample(Affine& X_CM)
+{
+    return calib_samples.pop(X_CM);
+}
+
 } // ns pt_impl
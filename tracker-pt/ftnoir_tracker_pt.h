@@ -13,6 +13,7 @@
 #include "point_tracker.h"
 #include "cv/numeric.hpp"
 #include "video/video-widget.hpp"
+#include "compat/spsc-queue.hpp"
 
 #include <atomic>
 #include <memory>
@@ -46,11 +47,20 @@ struct Tracker_PT : QThread, ITracker
     [[nodiscard]] bool get_cam_info(pt_camera_info& info);
     Affine pose() const;
 
+    // translation calibration gets the pose of every solved frame
+    void set_calibrating(bool x);
+    bool pop_calibration_sample(Affine& X_CM);
+
 private:
+    static constexpr int reopen_interval_ms = 500;
+    // camera crop around the points, in full field of view pixels
+    static constexpr int roi_margin_px = 32, roi_align_px = 16;
+
     void run() override;
 
     bool maybe_reopen_camera();
     void set_fov(int value);
+    void update_roi(const pt_camera_info& info, bool success);
 
     pointer<pt_runtime_traits> traits;
 
@@ -63,6 +73,10 @@ private:
     std::unique_ptr<QLayout> layout;
     std::vector<vec2> points;
 
+    // guarded by camera_mtx
+    cv::Rect roi;
+    bool roi_supported = true;
+
     int preview_width = 320, preview_height = 240;
 
     pointer<pt_point_extractor> point_extractor;
@@ -73,6 +87,8 @@ private:
 
     std::atomic<unsigned> point_count { 0 };
     std::atomic<bool> ever_success = false;
+    std::atomic<bool> calibrating = false;
+    spsc_queue<Affine, 256> calib_samples;
     mutable QMutex center_lock, data_lock;
 };
 
@@ -36,6 +36,9 @@ TrackerDialog_PT::TrackerDialog_PT(const QString& module_name) :
         ui.camdevice_combo->addItem(str);
 
     tie_setting(s.camera_name, ui.camdevice_combo);
+    // only on user selection, the saved id must survive the saved name now meaning another camera
+    connect(ui.camdevice_combo, static_cast<void(QComboBox::*)(int)>(&QComboBox::activated), this,
+            [this](int) { s.camera_id = video::camera_id(ui.camdevice_combo->currentText()); });
     tie_setting(s.cam_res_x, ui.res_x_spin);
     tie_setting(s.cam_res_y, ui.res_y_spin);
     tie_setting(s.cam_fps, ui.fps_spin);
@@ -44,6 +47,7 @@ TrackerDialog_PT::TrackerDialog_PT(const QString& module_name) :
 
     tie_setting(s.min_point_size, ui.mindiam_spin);
     tie_setting(s.max_point_size, ui.maxdiam_spin);
+    tie_setting(s.extraction_threads, ui.extraction_threads);
 
     tie_setting(s.clip_by, ui.clip_bheight_spin);
     tie_setting(s.clip_bz, ui.clip_blength_spin);
@@ -88,7 +92,7 @@ TrackerDialog_PT::TrackerDialog_PT(const QString& module_name) :
     timer.setInterval(250);
 
     connect(&calib_timer, &QTimer::timeout, this, &TrackerDialog_PT::trans_calib_step);
-    calib_timer.setInterval(35);
+    calib_timer.setInterval(100);
 
     poll_tracker_info_impl();
 
@@ -113,6 +117,28 @@ TrackerDialog_PT::TrackerDialog_PT(const QString& module_name) :
 
     tie_setting(s.blob_color, ui.blob_color);
 
+    constexpr pt_pose_solver solver_types[] = {
+        pt_solver_posit,
+        pt_solver_p3p,
+    };
+
+    for (unsigned k = 0; k < std::size(solver_types); k++)
+        ui.pose_solver->setItemData(k, int(solver_types[k]));
+
+    tie_setting(s.pose_solver, ui.pose_solver);
+    tie_setting(s.camera_roi, ui.camera_roi);
+
+    constexpr pt_detect_decimation decimation_types[] = {
+        pt_decimate_none,
+        pt_decimate_2x,
+        pt_decimate_4x,
+    };
+
+    for (unsigned k = 0; k < std::size(decimation_types); k++)
+        ui.detect_decimation->setItemData(k, int(decimation_types[k]));
+
+    tie_setting(s.detect_decimation, ui.detect_decimation);
+
     tie_setting(s.threshold_slider, ui.threshold_value_display, [this](const slider_value& val) {
         return threshold_display_text(int(val));
     });
@@ -157,8 +183,16 @@ void TrackerDialog_PT::startstop_trans_calib(bool start)
     if (start)
     {
         qDebug() << "pt: starting translation calibration";
-        calib_timer.start();
         trans_calib.reset();
+        if (tracker)
+        {
+            // discard anything left over from an earlier run
+            Affine X_CM;
+            while (tracker->pop_calibration_sample(X_CM))
+                continue;
+            tracker->set_calibrating(true);
+        }
+        calib_timer.start();
         s.t_MH_x = 0;
         s.t_MH_y = 0;
         s.t_MH_z = 0;
@@ -169,6 +203,11 @@ void TrackerDialog_PT::startstop_trans_calib(bool start)
     {
         calib_timer.stop();
         qDebug() << "pt: stopping translation calibration";
+        if (tracker)
+        {
+            tracker->set_calibrating(false);
+            drain_calibration_samples();
+        }
         {
             auto [tmp, nsamples] = trans_calib.get_estimate();
             s.t_MH_x = int(tmp[0]);
@@ -240,17 +279,29 @@ void TrackerDialog_PT::show_camera_settings()
         (void)video::show_dialog(s.camera_name);
 }
 
-void TrackerDialog_PT::trans_calib_step()
+void TrackerDialog_PT::drain_calibration_samples()
 {
-    QMutexLocker l(&calibrator_mutex);
+    Affine X_CM;
+    while (tracker->pop_calibration_sample(X_CM))
+        trans_calib.update(X_CM.R, X_CM.t);
+}
 
-    if (tracker)
+void TrackerDialog_PT::trans_calib_step()
+{
     {
-        Affine X_CM = tracker->pose();
-        trans_calib.update(X_CM.R, X_CM.t);
+        QMutexLocker l(&calibrator_mutex);
+
+        if (tracker)
+        {
+            drain_calibration_samples();
+
+            auto nsamples = trans_calib.get_sample_count();
+            ui.sample_count_display->setText(tr("%1 yaw, %2 pitch samples").arg(nsamples[0]).arg(nsamples[1]));
+            return;
+        }
     }
-    else
-        startstop_trans_calib(false);
+
+    startstop_trans_calib(false);
 }
 
 void TrackerDialog_PT::save()
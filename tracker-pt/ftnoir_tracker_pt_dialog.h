@@ -40,6 +40,7 @@ signals:
     void poll_tracker_info();
 protected:
     QString threshold_display_text(int threshold_value);
+    void drain_calibration_samples();
 
     pt_settings s;
     Tracker_PT* tracker;
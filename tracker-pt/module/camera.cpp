@@ -10,6 +10,8 @@
 
 #include "compat/math-imports.hpp"
 
+#include <algorithm>
+
 #include <opencv2/core.hpp>
 
 namespace pt_module {
@@ -44,7 +46,8 @@ Camera::result Camera::get_info() const
 
 Camera::result Camera::get_frame(pt_frame& frame_)
 {
-    cv::Mat& frame = frame_.as<Frame>()->mat;
+    Frame& fr = *frame_.as<Frame>();
+    cv::Mat& frame = fr.mat;
 
     const bool new_frame = get_frame_(frame);
 
@@ -63,10 +66,23 @@ Camera::result Camera::get_frame(pt_frame& frame_)
             dt_mean = (1-alpha) * dt_mean + alpha * dt;
 
         cam_info.fps = dt_mean > dt_eps ? 1 / dt_mean : 0;
-        cam_info.res_x = frame.cols;
-        cam_info.res_y = frame.rows;
         cam_info.fov = fov;
 
+        fr.roi_x = roi_x; fr.roi_y = roi_y; fr.binning = binning;
+
+        // points are in the full field of view, whatever the camera sends
+        if (full_res_x > 0 && full_res_y > 0 && (roi_active || roi_x || roi_y || binning != 1))
+        {
+            cam_info.res_x = fr.full_width = full_res_x;
+            cam_info.res_y = fr.full_height = full_res_y;
+        }
+        else
+        {
+            cam_info.res_x = frame.cols;
+            cam_info.res_y = frame.rows;
+            fr.full_width = 0; fr.full_height = 0;
+        }
+
         return { true, cam_info };
     }
     else
@@ -77,7 +93,11 @@ bool Camera::start(const QString& name, int fps, int res_x, int res_y)
 {
     if (fps >= 0 && res_x >= 0 && res_y >= 0)
     {
+        // other color modes need all three channels
+        const bool luma = s.blob_color == pt_color_natural;
+
         if (cam_desired.name != name ||
+            accept_luma != luma ||
             (int)cam_desired.fps != fps ||
             cam_desired.res_x != res_x ||
             cam_desired.res_y != res_y ||
@@ -90,6 +110,7 @@ bool Camera::start(const QString& name, int fps, int res_x, int res_y)
             cam_desired.res_x = res_x;
             cam_desired.res_y = res_y;
             cam_desired.fov = fov;
+            accept_luma = luma;
 
             cap = video::make_camera(name);
 
@@ -100,10 +121,15 @@ bool Camera::start(const QString& name, int fps, int res_x, int res_y)
             info.fps = fps;
             info.width = res_x;
             info.height = res_y;
+            info.accept_luma = luma;
 
             if (!cap->start(info))
                 goto fail;
 
+            full_res_x = info.width;
+            full_res_y = info.height;
+            roi_active = false;
+
             cam_info = pt_camera_info();
             cam_info.name = name;
             dt_mean = 0;
@@ -127,10 +153,35 @@ fail:
 void Camera::stop()
 {
     cap = nullptr;
+    full_res_x = 0; full_res_y = 0;
+    roi_x = 0; roi_y = 0; binning = 1;
+    roi_active = false;
     cam_info = {};
     cam_desired = {};
 }
 
+bool Camera::set_roi(int x, int y, int w, int h)
+{
+    if (!cap || !cap->is_open())
+        return false;
+
+    // already there, don't restart the stream for nothing
+    if ((w <= 0 || h <= 0) && !roi_active)
+        return true;
+
+    video::impl::camera::roi r;
+    r.x = x; r.y = y; r.width = w; r.height = h;
+
+    const bool ret = cap->set_roi(r);
+    roi_active = ret && w > 0 && h > 0;
+    return ret;
+}
+
+bool Camera::is_open() const
+{
+    return cap && cap->is_open();
+}
+
 bool Camera::get_frame_(cv::Mat& img)
 {
     if (cap && cap->is_open())
@@ -142,6 +193,9 @@ bool Camera::get_frame_(cv::Mat& img)
             if (stride == 0)
                 stride = cv::Mat::AUTO_STEP;
             img = cv::Mat(frame.height, frame.width, CV_8UC(frame.channels), (void*)frame.data, stride);
+            roi_x = frame.roi_x;
+            roi_y = frame.roi_y;
+            binning = std::max(1, frame.binning);
             return true;
         }
     }
@@ -25,6 +25,7 @@ struct Camera final : pt_camera
 
     bool start(const QString& name, int fps, int res_x, int res_y) override;
     void stop() override;
+    bool is_open() const override;
 
     result get_frame(pt_frame& Frame) override;
     result get_info() const override;
@@ -35,6 +36,7 @@ struct Camera final : pt_camera
 
     void set_fov(f value) override { fov = value; }
     void show_camera_settings() override;
+    bool set_roi(int x, int y, int w, int h) override;
 
 private:
     using camera = video::impl::camera;
@@ -42,10 +44,16 @@ private:
     [[nodiscard]] bool get_frame_(cv::Mat& frame);
 
     f dt_mean = 0, fov = 30;
+    bool accept_luma = false;
     Timer t;
     pt_camera_info cam_info;
     pt_camera_info cam_desired;
 
+    // the size start() got, frames are smaller while cropping
+    int full_res_x = 0, full_res_y = 0;
+    int roi_x = 0, roi_y = 0, binning = 1;
+    bool roi_active = false;
+
     std::unique_ptr<camera> cap;
     pt_settings s;
 
@@ -10,14 +10,24 @@ Preview& Preview::operator=(const pt_frame& frame_)
 {
     const cv::Mat& frame = frame_.as_const<const Frame>()->mat;
 
-    if (frame.channels() != 3)
+    if (frame.channels() != 3 && frame.channels() != 1)
     {
-        eval_once(qDebug() << "tracker/pt: camera frame depth: 3 !=" << frame.channels());
+        eval_once(qDebug() << "tracker/pt: camera frame depth:" << frame.channels());
         return *this;
     }
 
     const bool need_resize = frame.cols != frame_out.cols || frame.rows != frame_out.rows;
-    if (need_resize)
+    if (frame.channels() == 1)
+    {
+        if (need_resize)
+        {
+            cv::resize(frame, frame_gray, cv::Size(frame_out.cols, frame_out.rows), 0, 0, cv::INTER_NEAREST);
+            cv::cvtColor(frame_gray, frame_copy, cv::COLOR_GRAY2BGR);
+        }
+        else
+            cv::cvtColor(frame, frame_copy, cv::COLOR_GRAY2BGR);
+    }
+    else if (need_resize)
         cv::resize(frame, frame_copy, cv::Size(frame_out.cols, frame_out.rows), 0, 0, cv::INTER_NEAREST);
     else
         frame.copyTo(frame_copy);
@@ -15,6 +15,9 @@ namespace pt_module {
 struct Frame final : pt_frame
 {
     cv::Mat mat;
+    // where `mat' lies in the camera's full field of view, see video::frame::roi_x;
+    // zero size if it is the full field of view
+    int roi_x = 0, roi_y = 0, binning = 1, full_width = 0, full_height = 0;
 
     operator const cv::Mat&() const& { return mat; }
     operator cv::Mat&() & { return mat; }
@@ -34,7 +37,7 @@ struct Preview final : pt_preview
 private:
     static void ensure_size(cv::Mat& frame, int w, int h, int type);
 
-    cv::Mat frame_copy, frame_out;
+    cv::Mat frame_copy, frame_out, frame_gray;
 };
 
 } // ns pt_module
@@ -23,7 +23,10 @@
 #include <cmath>
 #include <algorithm>
 #include <cinttypes>
+#include <cstdint>
+#include <limits>
 #include <memory>
+#include <numeric>
 
 #include <QDebug>
 
@@ -47,56 +50,121 @@ corresponding location is a good candidate for the extracted point.
 The idea similar to the window scaling suggested in  Berglund et al. "Fast, bias-free
 algorithm for tracking single particles with variable size and shape." (2008).
 */
-static vec2 MeanShiftIteration(const cv::Mat1b &frame_gray, const vec2 &current_center, f filter_width)
+// The kernel's weight is evaluated separably, the row's term once per row and the
+// column's term once per iteration. Rows and columns outside the kernel's support
+// are skipped. Products are accumulated in fixed point so that the loop vectorizes.
+static constexpr unsigned mean_shift_kernel_bits = 14;
+
+static vec2 MeanShiftIteration(const cv::Mat1w& frame_sq, const vec2& current_center, f filter_width, f* __restrict dx2)
 {
+    constexpr f kernel_scale = 1 << mean_shift_kernel_bits;
+
     const f s = 1 / filter_width;
+    const int W = frame_sq.cols, H = frame_sq.rows;
 
-    f m = 0;
-    vec2 com { 0, 0 };
-    for (int i = 0; i < frame_gray.rows; i++)
+    for (int j = 0; j < W; j++)
     {
-        uint8_t const* const __restrict frame_ptr = frame_gray.ptr(i);
-        for (int j = 0; j < frame_gray.cols; j++)
-        {
-            f val = frame_ptr[j];
-            val = val * val; // taking the square weighs brighter parts of the image stronger.
-            f dx = (j - current_center[0])*s;
-            f dy = (i - current_center[1])*s;
-            f max = std::fmax(f(0), 1 - dx*dx - dy*dy);
-            val *= max;
-            m += val;
-            com[0] += j * val;
-            com[1] += i * val;
-        }
+        const f dx = (j - current_center[0])*s;
+        dx2[j] = dx*dx;
     }
-    if (m > f(.1))
+
+    const int ymin = std::max(0, (int)std::floor(current_center[1] - filter_width)),
+              ymax = std::min(H-1, (int)std::ceil(current_center[1] + filter_width));
+
+    std::uint64_t m = 0, com_x = 0, com_y = 0;
+
+    for (int i = ymin; i <= ymax; i++)
     {
-        com *= 1 / m;
-        return com;
+        const f dy = (i - current_center[1])*s;
+        const f ay = 1 - dy*dy;
+
+        if (ay <= 0)
+            continue;
+
+        const f half_width = filter_width * std::sqrt(ay);
+        const int jmin = std::max(0, (int)std::floor(current_center[0] - half_width)),
+                  jmax = std::min(W-1, (int)std::ceil(current_center[0] + half_width));
+
+        std::uint16_t const* const __restrict frame_ptr = frame_sq.ptr<std::uint16_t>(i);
+        std::uint64_t m_row = 0, com_x_row = 0;
+
+        for (int j = jmin; j <= jmax; j++)
+        {
+            const f k = std::max(ay - dx2[j], f(0));
+            // at most 255^2 * 2^14, fits in 32 bits
+            const std::uint32_t val = frame_ptr[j] * (std::uint32_t)(k * kernel_scale);
+            m_row += val;
+            com_x_row += (std::uint64_t)val * (std::uint32_t)j;
+        }
+
+        m += m_row;
+        com_x += com_x_row;
+        com_y += m_row * (std::uint64_t)i;
     }
+
+    if (m > kernel_scale / 10)
+        return vec2(f(double(com_x) / m), f(double(com_y) / m));
     else
         return current_center;
 }
 
-namespace pt_module {
+// returns the refined blob center in `frame_gray' coordinates
+static vec2 mean_shift_center(const cv::Mat1b& frame_gray, cv::Rect rect, f radius,
+                              cv::Mat1w& frame_sq, std::vector<f>& dx2)
+{
+    rect.x -= rect.width / 2;
+    rect.y -= rect.height / 2;
+    rect.width *= 2;
+    rect.height *= 2;
+    rect &= cv::Rect(0, 0, frame_gray.cols, frame_gray.rows);  // crop at frame boundaries
 
-PointExtractor::PointExtractor(const QString& module_name) : s(module_name)
+    // taking the square weighs brighter parts of the image stronger.
+    cv::multiply(frame_gray(rect), frame_gray(rect), frame_sq, 1, CV_16U);
+    dx2.resize((unsigned)rect.width);
+
+    // smaller values mean more changes. 1 makes too many changes while 1.5 makes about .1
+    static constexpr f radius_c = f(1.75);
+
+    const f kernel_radius = radius * radius_c;
+    vec2 pos(rect.width/f(2), rect.height/f(2)); // position relative to ROI.
+    f last_step = std::numeric_limits<f>::infinity();
+
+    for (int iter = 0; iter < 10; ++iter)
+    {
+        vec2 com_new = MeanShiftIteration(frame_sq, pos, kernel_radius, dx2.data());
+        vec2 delta = com_new - pos;
+        pos = com_new;
+
+        const f step = delta.dot(delta);
+
+        // stop when converged, or when only oscillating by a fraction of a pixel
+        if (step < f(1e-3) || (step < f(1e-2) && step >= last_step))
+            break;
+
+        last_step = step;
+    }
+
+    return { pos[0] + rect.x, pos[1] + rect.y };
+}
+
+static void ensure_size(cv::Mat1b& mat, int w, int h)
 {
-    blobs.reserve(max_blobs);
+    if (mat.cols != w || mat.rows != h)
+        mat = cv::Mat1b(h, w);
 }
 
-void PointExtractor::ensure_channel_buffers(const cv::Mat& orig_frame)
+namespace pt_module {
+
+PointExtractor::PointExtractor(const QString& module_name) : s(module_name)
 {
-    if (ch[0].rows != orig_frame.rows || ch[0].cols != orig_frame.cols)
-        for (cv::Mat1b& x : ch)
-            x = cv::Mat1b(orig_frame.rows, orig_frame.cols);
+    blobs.reserve(max_blobs);
 }
 
 void PointExtractor::ensure_buffers(const cv::Mat& frame)
 {
     const int W = frame.cols, H = frame.rows;
 
-    if (frame_gray.rows != W || frame_gray.cols != H)
+    if (frame_gray.rows != H || frame_gray.cols != W)
     {
         frame_gray = cv::Mat1b(H, W);
         frame_bin = cv::Mat1b(H, W);
@@ -106,8 +174,6 @@ void PointExtractor::ensure_buffers(const cv::Mat& frame)
 
 void PointExtractor::extract_single_channel(const cv::Mat& orig_frame, int idx, cv::Mat1b& dest)
 {
-    ensure_channel_buffers(orig_frame);
-
     const int from_to[] = {
         idx, 0,
     };
@@ -117,14 +183,19 @@ void PointExtractor::extract_single_channel(const cv::Mat& orig_frame, int idx,
 
 void PointExtractor::filter_single_channel(const cv::Mat& orig_frame, float r, float g, float b, cv::Mat1b& dest)
 {
-    ensure_channel_buffers(orig_frame);
-
     cv::transform(orig_frame, dest, cv::Mat(cv::Matx13f(b, g, r)));
 }
 
-void PointExtractor::color_to_grayscale(const cv::Mat& frame, cv::Mat1b& output)
+void PointExtractor::color_to_grayscale(const cv::Mat& frame, cv::Mat1b& output, pt_color_type color)
 {
-    switch (s.blob_color)
+    if (frame.channels() == 1)
+    {
+        // the camera passed luma through already
+        frame.copyTo(output);
+        return;
+    }
+
+    switch (color)
     {
     case pt_color_green_only:
     {
@@ -180,7 +251,7 @@ void PointExtractor::color_to_grayscale(const cv::Mat& frame, cv::Mat1b& output)
         break;
     }
     default:
-        eval_once(qDebug() << "wrong pt_color_type enum value" << int(s.blob_color));
+        eval_once(qDebug() << "wrong pt_color_type enum value" << int(color));
     [[fallthrough]];
     case pt_color_natural:
         cv::cvtColor(frame, output, cv::COLOR_BGR2GRAY);
@@ -188,45 +259,63 @@ void PointExtractor::color_to_grayscale(const cv::Mat& frame, cv::Mat1b& output)
     }
 }
 
-void PointExtractor::threshold_image(const cv::Mat& frame_gray, cv::Mat1b& output)
+void PointExtractor::calc_histogram(const cv::Mat& frame_gray, cv::Mat1f& hist)
+{
+    const int hist_size = 256;
+    const float ranges_[] = { 0, 256 };
+    float const* ranges = (const float*) ranges_;
+
+    cv::calcHist(&frame_gray,
+                 1,
+                 nullptr,
+                 cv::noArray(),
+                 hist,
+                 1,
+                 &hist_size,
+                 &ranges);
+}
+
+int PointExtractor::threshold_from_histogram(const cv::Mat1f& hist, int w, int h, int threshold_slider_value)
+{
+    const f radius = threshold_radius_value(w, h, threshold_slider_value);
+
+    float const* const __restrict ptr = hist.ptr<float>(0);
+    const unsigned area = uround(3 * pi * radius*radius);
+    const unsigned sz = unsigned(hist.cols * hist.rows);
+    constexpr unsigned min_thres = 64;
+    unsigned thres = min_thres;
+    for (unsigned i = sz-1, cnt = 0; i > 32; i--)
+    {
+        cnt += (unsigned)ptr[i];
+        if (cnt >= area)
+            break;
+        thres = i;
+    }
+
+    return (int)thres;
+}
+
+int PointExtractor::threshold_image(const cv::Mat& frame_gray, cv::Mat1b& output)
 {
     const int threshold_slider_value = s.threshold_slider.to<int>();
+    const f region_size_min = (f)s.min_point_size;
+    const f region_size_max = (f)s.max_point_size;
 
     if (!s.auto_threshold)
     {
         cv::threshold(frame_gray, output, threshold_slider_value, 255, cv::THRESH_BINARY);
+        return threshold_slider_value;
     }
     else
     {
-        const int hist_size = 256;
-        const float ranges_[] = { 0, 256 };
-        float const* ranges = (const float*) ranges_;
-
-        cv::calcHist(&frame_gray,
-                     1,
-                     nullptr,
-                     cv::noArray(),
-                     hist,
-                     1,
-                     &hist_size,
-                     &ranges);
-
-        const f radius = threshold_radius_value(frame_gray.cols, frame_gray.rows, threshold_slider_value);
-
-        float const* const __restrict ptr = hist.ptr<float>(0);
-        const unsigned area = uround(3 * pi * radius*radius);
-        const unsigned sz = unsigned(hist.cols * hist.rows);
-        constexpr unsigned min_thres = 64;
-        unsigned thres = min_thres;
-        for (unsigned i = sz-1, cnt = 0; i > 32; i--)
-        {
-            cnt += (unsigned)ptr[i];
-            if (cnt >= area)
-                break;
-            thres = i;
-        }
+        calc_histogram(frame_gray, hist);
+        const int thres = threshold_from_histogram(hist,
+                                                   iround(frame_gray.cols * crop_scale_x),
+                                                   iround(frame_gray.rows * crop_scale_y),
+                                                   threshold_slider_value);
 
         cv::threshold(frame_gray, output, thres, 255, cv::THRESH_BINARY);
+        return thres;
     }
 }
 
@@ -275,12 +364,74 @@ static void draw_blobs(cv::Mat& preview_frame, const blob* blobs, unsigned nblob
     }
 }
 
-void PointExtractor::extract_points(const pt_frame& frame_, pt_preview& preview_frame_, std::vector<vec2>& points)
+void PointExtractor::find_blobs(cv::Mat1b& frame_bin, const cv::Mat1b& frame_gray,
+                                f region_size_min, f region_size_max, std::vector<blob>& out)
 {
-    const cv::Mat& frame = frame_.as_const<Frame>()->mat;
+    unsigned idx = 0;
+
+    for (int y=0; y < frame_bin.rows; y++)
+    {
+        const unsigned char* __restrict ptr_bin = frame_bin.ptr(y);
+        for (int x=0; x < frame_bin.cols; x++)
+        {
+            if (ptr_bin[x] != 255)
+                continue;
+            idx = out.size() + 1;
+
+            cv::Rect rect;
+            cv::floodFill(frame_bin,
+                          cv::Point(x,y),
+                          cv::Scalar(idx),
+                          &rect,
+                          cv::Scalar(0),
+                          cv::Scalar(0),
+                          4 | cv::FLOODFILL_FIXED_RANGE);
+
+            unsigned cnt = 0;
+            unsigned norm = 0;
+
+            const int ymax = rect.y+rect.height,
+                      xmax = rect.x+rect.width;
+
+            for (int i=rect.y; i < ymax; i++)
+            {
+                unsigned char const* const __restrict ptr_blobs = frame_bin.ptr(i);
+                unsigned char const* const __restrict ptr_gray = frame_gray.ptr(i);
+                for (int j=rect.x; j < xmax; j++)
+                {
+                    if (ptr_blobs[j] != idx)
+                        continue;
+
+                    //ptr_blobs[j] = 0;
+                    norm += ptr_gray[j];
+                    cnt++;
+                }
+            }
+
+            const f radius = std::sqrt(cnt / pi);
+            if (radius > region_size_max || radius < region_size_min)
+                continue;
+
+            out.emplace_back(radius,
+                             vec2(rect.width/f(2), rect.height/f(2)),
+                             std::pow(f(norm), f(1.1))/cnt,
+                             rect);
+
+            if (idx >= max_blobs)
+                return;
+
+            // XXX we could go to the next scanline unless the points are really small.
+            // i'd expect each point being present on at least one unique scanline
+            // but it turns out some people are using 2px points -sh 20180110
+            //break;
+        }
+    }
+}
 
+void PointExtractor::extract_blobs(const cv::Mat& frame)
+{
     ensure_buffers(frame);
-    color_to_grayscale(frame, frame_gray_unmasked);
+    color_to_grayscale(frame, frame_gray_unmasked, s.blob_color);
 
 #if defined PREVIEW
     cv::imshow("capture", frame_gray);
@@ -288,14 +439,98 @@ void PointExtractor::extract_points(const pt_frame& frame_, pt_preview& preview_
 #endif
 
     threshold_image(frame_gray_unmasked, frame_bin);
-    frame_gray_unmasked.copyTo(frame_gray, frame_bin);
+    cv::bitwise_and(frame_gray_unmasked, frame_bin, frame_gray);
+
+    find_blobs(frame_bin, frame_gray, (f)s.min_point_size, (f)s.max_point_size, blobs);
+
+    for (blob& b : blobs)
+        b.pos = mean_shift_center(frame_gray, b.rect, b.radius, mean_shift_sq, mean_shift_dx2);
+}
+
+void PointExtractor::extract_blobs_coarse(const cv::Mat& frame, int decimation)
+{
+    // Find blob candidates on a decimated image, then threshold and
+    // mean-shift only full-resolution ROIs around them. The box filter
+    // keeps small points visible at the lower resolution.
+
+    const int W = frame.cols, H = frame.rows;
+    const f d = (f)decimation;
+    const pt_color_type color = s.blob_color;
+
+    cv::resize(frame, frame_coarse, cv::Size(W / decimation, H / decimation), 0, 0, cv::INTER_AREA);
+    ensure_size(frame_gray_coarse, frame_coarse.cols, frame_coarse.rows);
+    color_to_grayscale(frame_coarse, frame_gray_coarse, color);
+
+    // the auto threshold's point radius scales with the image size already
+    const int thres = threshold_image(frame_gray_coarse, frame_bin_coarse);
 
     const f region_size_min = (f)s.min_point_size;
     const f region_size_max = (f)s.max_point_size;
 
-    unsigned idx = 0;
+    // point sizes scale with 1/decimation, leave some slack for the blurred edges
+    candidates.clear();
+    find_blobs(frame_bin_coarse, frame_gray_coarse,
+               region_size_min / (2*d), region_size_max / d + 1,
+               candidates);
 
-    blobs.clear();
+    for (const blob& c : candidates)
+    {
+        const cv::Rect cand(c.rect.x * decimation - decimation,
+                            c.rect.y * decimation - decimation,
+                            (c.rect.width + 2) * decimation,
+                            (c.rect.height + 2) * decimation);
+
+        // enlarge the same way as for mean shift
+        cv::Rect roi(cand.x - cand.width/2, cand.y - cand.height/2, cand.width*2, cand.height*2);
+        roi &= cv::Rect(0, 0, W, H);
+
+        if (roi.empty())
+            continue;
+
+        frame(roi).copyTo(roi_color);
+        ensure_size(roi_gray_unmasked, roi.width, roi.height);
+        color_to_grayscale(roi_color, roi_gray_unmasked, color);
+        cv::threshold(roi_gray_unmasked, roi_bin, thres, 255, cv::THRESH_BINARY);
+        cv::bitwise_and(roi_gray_unmasked, roi_bin, roi_gray);
+
+        roi_blobs.clear();
+        find_blobs(roi_bin, roi_gray, region_size_min, region_size_max, roi_blobs);
+
+        for (blob& b : roi_blobs)
+        {
+            // ROIs of nearby candidates overlap, only keep the blobs centered on this one
+            const cv::Point center(roi.x + b.rect.x + b.rect.width/2,
+                                   roi.y + b.rect.y + b.rect.height/2);
+            if (!cand.contains(center))
+                continue;
+
+            b.pos = mean_shift_center(roi_gray, b.rect, b.radius, mean_shift_sq, mean_shift_dx2);
+            b.pos[0] += roi.x; b.pos[1] += roi.y;
+            b.rect.x += roi.x; b.rect.y += roi.y;
+
+            blobs.push_back(b);
+
+            if ((int)blobs.size() >= max_blobs)
+                return;
+        }
+    }
+}
+
+void PointExtractor::ensure_pool(unsigned nthreads)
+{
+    if (!pool || pool->size() != nthreads)
+    {
+        pool = nullptr;
+        pool = std::make_unique<worker_pool>(nthreads, "tracker/pt/extract");
+    }
+}
+
+bool PointExtractor::label_components(cv::Mat1b& frame_bin, const cv::Mat1b& frame_gray, int y0,
+                                      f region_size_min, f region_size_max, std::vector<component>& out)
+{
+    // same as find_blobs(), but components touching the tile's top or bottom
+    // row are kept regardless of size, they may continue in the next tile
+    out.clear();
 
     for (int y=0; y < frame_bin.rows; y++)
     {
@@ -304,7 +539,10 @@ void PointExtractor::extract_points(const pt_frame& frame_, pt_preview& preview_
         {
             if (ptr_bin[x] != 255)
                 continue;
-            idx = blobs.size() + 1;
+            if (out.size() >= max_tile_components)
+                return false;
+
+            const unsigned idx = out.size() + 1;
 
             cv::Rect rect;
             cv::floodFill(frame_bin,
@@ -330,75 +568,210 @@ void PointExtractor::extract_points(const pt_frame& frame_, pt_preview& preview_
                     if (ptr_blobs[j] != idx)
                         continue;
 
-                    //ptr_blobs[j] = 0;
                     norm += ptr_gray[j];
                     cnt++;
                 }
             }
 
             const f radius = std::sqrt(cnt / pi);
-            if (radius > region_size_max || radius < region_size_min)
+            const bool on_seam = rect.y == 0 || rect.y + rect.height == frame_bin.rows;
+
+            // noise doesn't get to use up the labels
+            if (!on_seam && (radius > region_size_max || radius < region_size_min))
+            {
+                for (int i=rect.y; i < ymax; i++)
+                {
+                    unsigned char* const __restrict ptr_blobs = frame_bin.ptr(i);
+                    for (int j=rect.x; j < xmax; j++)
+                        if (ptr_blobs[j] == idx)
+                            ptr_blobs[j] = 0;
+                }
                 continue;
+            }
 
-            blobs.emplace_back(radius,
-                               vec2(rect.width/f(2), rect.height/f(2)),
-                               std::pow(f(norm), f(1.1))/cnt,
-                               rect);
+            rect.y += y0;
+            out.push_back({ cnt, norm, rect });
+        }
+    }
 
-            if (idx >= max_blobs)
-                goto end;
+    return true;
+}
 
-            // XXX we could go to the next scanline unless the points are really small.
-            // i'd expect each point being present on at least one unique scanline
-            // but it turns out some people are using 2px points -sh 20180110
-            //break;
-        }
+static unsigned find_root(std::vector<unsigned>& parent, unsigned i)
+{
+    while (parent[i] != i)
+    {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+void PointExtractor::extract_blobs_tiled(const cv::Mat& frame, unsigned nthreads)
+{
+    // Grayscale conversion, thresholding and labeling run on horizontal
+    // strips in parallel. Components crossing the strips' seams are merged
+    // before filtering them by size.
+
+    ensure_buffers(frame);
+    ensure_pool(nthreads);
+
+    const int W = frame.cols, H = frame.rows;
+    const unsigned ntiles = std::min(nthreads, unsigned(H / min_tile_rows));
+
+    const pt_color_type color = s.blob_color;
+    const bool auto_threshold = s.auto_threshold;
+    const int threshold_slider_value = s.threshold_slider.to<int>();
+
+    tile_hist.resize(ntiles);
+    tile_components.resize(ntiles);
+    tile_overflow.assign(ntiles, false);
+
+    auto tile_rows = [=](unsigned k) {
+        return cv::Range(int(unsigned(H) * k / ntiles), int(unsigned(H) * (k+1) / ntiles));
+    };
+
+    pool->run(ntiles, [&](unsigned k) {
+        const cv::Range rows = tile_rows(k);
+        cv::Mat1b gray = frame_gray_unmasked.rowRange(rows);
+
+        color_to_grayscale(frame.rowRange(rows), gray, color);
+
+        if (auto_threshold)
+            calc_histogram(gray, tile_hist[k]);
+    });
+
+    int thres = threshold_slider_value;
+
+    if (auto_threshold)
+    {
+        tile_hist[0].copyTo(hist);
+        for (unsigned k = 1; k < ntiles; k++)
+            hist += tile_hist[k];
+        thres = threshold_from_histogram(hist, iround(W * crop_scale_x), iround(H * crop_scale_y), threshold_slider_value);
     }
-end:
 
-    const int W = frame_gray.cols;
-    const int H = frame_gray.rows;
+    pool->run(ntiles, [&](unsigned k) {
+        const cv::Range rows = tile_rows(k);
+        const cv::Mat1b gray_unmasked = frame_gray_unmasked.rowRange(rows);
+        cv::Mat1b bin = frame_bin.rowRange(rows), gray = frame_gray.rowRange(rows);
 
-    const unsigned sz = blobs.size();
+        cv::threshold(gray_unmasked, bin, thres, 255, cv::THRESH_BINARY);
+        cv::bitwise_and(gray_unmasked, bin, gray);
 
-    std::sort(blobs.begin(), blobs.end(), [](const blob& b1, const blob& b2) { return b2.brightness < b1.brightness; });
+        tile_overflow[k] = !label_components(bin, gray, rows.start,
+                                             region_size_min, region_size_max,
+                                             tile_components[k]);
+    });
 
-    for (idx = 0; idx < sz; ++idx)
+    // too many points in some tile, they'd be dropped without a label
+    if (std::any_of(tile_overflow.cbegin(), tile_overflow.cend(), [](char x) { return x != 0; }))
     {
-        blob& b = blobs[idx];
-        cv::Rect rect = b.rect;
+        extract_blobs(frame);
+        return;
+    }
+
+    components.clear();
+    for (const auto& c : tile_components)
+        components.insert(components.end(), c.cbegin(), c.cend());
+
+    const unsigned ncomponents = components.size();
+    component_parent.resize(ncomponents);
+    std::iota(component_parent.begin(), component_parent.end(), 0u);
+
+    // 4-connectivity, so only vertical neighbors across the seam matter
+    for (unsigned k = 0, base = 0; k + 1 < ntiles; k++)
+    {
+        const unsigned next = base + tile_components[k].size();
+        const int y = tile_rows(k).end;
+
+        unsigned char const* const __restrict above = frame_bin.ptr(y - 1);
+        unsigned char const* const __restrict below = frame_bin.ptr(y);
+
+        for (int x = 0; x < W; x++)
+        {
+            const unsigned a = above[x], b = below[x];
 
-        rect.x -= rect.width / 2;
-        rect.y -= rect.height / 2;
-        rect.width *= 2;
-        rect.height *= 2;
-        rect &= cv::Rect(0, 0, W, H);  // crop at frame boundaries
+            if (a == 0 || b == 0 || a > max_tile_components || b > max_tile_components)
+                continue;
 
-        cv::Mat frame_roi = frame_gray(rect);
+            const unsigned ra = find_root(component_parent, base + a - 1),
+                           rb = find_root(component_parent, next + b - 1);
 
-        // smaller values mean more changes. 1 makes too many changes while 1.5 makes about .1
-        static constexpr f radius_c = f(1.75);
+            // the root is always the first component in scan order
+            if (ra != rb)
+                component_parent[std::max(ra, rb)] = std::min(ra, rb);
+        }
 
-        const f kernel_radius = b.radius * radius_c;
-        vec2 pos(rect.width/f(2), rect.height/f(2)); // position relative to ROI.
+        base = next;
+    }
 
-        for (int iter = 0; iter < 10; ++iter)
+    for (unsigned i = 0; i < ncomponents; i++)
+    {
+        const unsigned r = find_root(component_parent, i);
+        if (r != i)
         {
-            vec2 com_new = MeanShiftIteration(frame_roi, pos, kernel_radius);
-            vec2 delta = com_new - pos;
-            pos = com_new;
-            if (delta.dot(delta) < f(1e-3))
-                break;
+            component& c = components[r];
+            c.cnt += components[i].cnt;
+            c.norm += components[i].norm;
+            c.rect |= components[i].rect;
         }
+    }
+
+    for (unsigned i = 0; i < ncomponents; i++)
+    {
+        if (find_root(component_parent, i) != i)
+            continue;
+
+        const component& c = components[i];
+        const f radius = std::sqrt(c.cnt / pi);
+
+        if (radius > region_size_max || radius < region_size_min)
+            continue;
 
-        b.pos[0] = pos[0] + rect.x;
-        b.pos[1] = pos[1] + rect.y;
+        blobs.emplace_back(radius,
+                           vec2(c.rect.width/f(2), c.rect.height/f(2)),
+                           std::pow(f(c.norm), f(1.1))/c.cnt,
+                           c.rect);
+
+        if ((int)blobs.size() >= max_blobs)
+            break;
     }
 
+    for (blob& b : blobs)
+        b.pos = mean_shift_center(frame_gray, b.rect, b.radius, mean_shift_sq, mean_shift_dx2);
+}
+
+void PointExtractor::extract_points(const pt_frame& frame_, pt_preview& preview_frame_, std::vector<vec2>& points)
+{
+    const Frame& fr = *frame_.as_const<Frame>();
+    const cv::Mat& frame = fr.mat;
+    const bool cropped = fr.full_width > 0 && fr.full_height > 0 && !frame.empty();
+
+    // the point size the auto threshold expects goes with the binned full field of view
+    crop_scale_x = cropped ? fr.full_width / f(fr.binning * frame.cols) : 1;
+    crop_scale_y = cropped ? fr.full_height / f(fr.binning * frame.rows) : 1;
+
+    const int decimation = s.detect_decimation;
+    const int nthreads = std::clamp(*s.extraction_threads, 1, max_threads);
+
+    blobs.clear();
+
+    if (decimation > 1 && frame.cols >= 160 * decimation && frame.rows >= 120 * decimation)
+        extract_blobs_coarse(frame, decimation);
+    else if (nthreads > 1 && frame.rows >= 2 * min_tile_rows)
+        extract_blobs_tiled(frame, unsigned(nthreads));
+    else
+        extract_blobs(frame);
+
+    const int W = cropped ? fr.full_width : frame.cols;
+    const int H = cropped ? fr.full_height : frame.rows;
+
+    std::sort(blobs.begin(), blobs.end(), [](const blob& b1, const blob& b2) { return b2.brightness < b1.brightness; });
+
     draw_blobs(preview_frame_.as<Frame>()->mat,
                blobs.data(), blobs.size(),
-               frame_gray.size());
-
+               frame.size());
 
     // End of mean shift code. At this point, blob positions are updated with hopefully less noisy less biased values.
     points.reserve(max_blobs);
@@ -409,7 +782,7 @@ end:
         // note: H/W is equal to fx/fy
 
         vec2 p;
-        std::tie(p[0], p[1]) = to_screen_pos(b.pos[0], b.pos[1], W, H);
+        std::tie(p[0], p[1]) = to_screen_pos(fr.roi_x + b.pos[0] * fr.binning, fr.roi_y + b.pos[1] * fr.binning, W, H);
         points.push_back(p);
     }
 }
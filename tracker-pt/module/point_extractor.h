@@ -9,7 +9,9 @@
 #pragma once
 
 #include "pt-api.hpp"
+#include "compat/worker-pool.hpp"
 
+#include <memory>
 #include <vector>
 
 #include <opencv2/core.hpp>
@@ -40,19 +42,60 @@ private:
 
     pt_settings s;
 
+    // full field of view over frame size, when the camera crops
+    f crop_scale_x = 1, crop_scale_y = 1;
+
     cv::Mat1b frame_gray_unmasked, frame_bin, frame_gray;
     cv::Mat1f hist;
     std::vector<blob> blobs;
-    cv::Mat1b ch[3];
 
-    void ensure_channel_buffers(const cv::Mat& orig_frame);
+    cv::Mat1w mean_shift_sq;
+    std::vector<f> mean_shift_dx2;
+
+    // coarse-to-fine detection
+    cv::Mat frame_coarse, roi_color;
+    cv::Mat1b frame_gray_coarse, frame_bin_coarse;
+    cv::Mat1b roi_gray_unmasked, roi_bin, roi_gray;
+    std::vector<blob> candidates, roi_blobs;
+
+    // tiled extraction
+    struct component final
+    {
+        unsigned cnt, norm;
+        cv::Rect rect;
+    };
+
+    static constexpr int max_threads = 16;
+    static constexpr int min_tile_rows = 32;
+    static constexpr unsigned max_tile_components = 254; // 255 marks unlabeled pixels
+
+    std::unique_ptr<worker_pool> pool;
+    std::vector<cv::Mat1f> tile_hist;
+    std::vector<std::vector<component>> tile_components;
+    std::vector<char> tile_overflow;
+    std::vector<component> components;
+    std::vector<unsigned> component_parent;
+
     void ensure_buffers(const cv::Mat& frame);
+    void ensure_pool(unsigned nthreads);
+
+    static void extract_single_channel(const cv::Mat& orig_frame, int idx, cv::Mat1b& dest);
+    static void filter_single_channel(const cv::Mat& orig_frame, float r, float g, float b, cv::Mat1b& dest);
+
+    static void color_to_grayscale(const cv::Mat& frame, cv::Mat1b& output, pt_color_type color);
+    static void calc_histogram(const cv::Mat& frame_gray, cv::Mat1f& hist);
+    static int threshold_from_histogram(const cv::Mat1f& hist, int w, int h, int threshold_slider_value);
+    int threshold_image(const cv::Mat& frame_gray, cv::Mat1b& output);
 
-    void extract_single_channel(const cv::Mat& orig_frame, int idx, cv::Mat1b& dest);
-    void filter_single_channel(const cv::Mat& orig_frame, float r, float g, float b, cv::Mat1b& dest);
+    void find_blobs(cv::Mat1b& frame_bin, const cv::Mat1b& frame_gray,
+                    f region_size_min, f region_size_max, std::vector<blob>& out);
+    // false if the tile has more components than labels
+    [[nodiscard]] static bool label_components(cv::Mat1b& frame_bin, const cv::Mat1b& frame_gray, int y0,
+                                               f region_size_min, f region_size_max, std::vector<component>& out);
 
-    void color_to_grayscale(const cv::Mat& frame, cv::Mat1b& output);
-    void threshold_image(const cv::Mat& frame_gray, cv::Mat1b& output);
+    void extract_blobs(const cv::Mat& frame);
+    void extract_blobs_coarse(const cv::Mat& frame, int decimation);
+    void extract_blobs_tiled(const cv::Mat& frame, unsigned nthreads);
 };
 
 } // ns impl
@@ -136,7 +136,8 @@ PointTracker::PointOrder PointTracker::find_correspondences_previous(const vec2*
 void PointTracker::track(const std::vector<vec2>& points,
                          const PointModel& model,
                          const pt_camera_info& info,
-                         int init_phase_timeout)
+                         int init_phase_timeout,
+                         pt_pose_solver solver)
 {
     const f fx = pt_camera_info::get_focal_length(info.fov, info.res_x, info.res_y);
     PointOrder order;
@@ -149,7 +150,15 @@ void PointTracker::track(const std::vector<vec2>& points,
     else
         order = find_correspondences_previous(points.data(), model, info);
 
-    if (POSIT(model, order, fx) != -1)
+    int ret = -1;
+
+    // fall back to POSIT if there's no valid closed-form solution, e.g. in degenerate configurations
+    if (solver == pt_solver_p3p)
+        ret = P3P(model, order, fx);
+    if (ret == -1)
+        ret = POSIT(model, order, fx);
+
+    if (ret != -1)
     {
         init_phase = false;
         t.start();
@@ -344,6 +353,239 @@ int PointTracker::POSIT(const PointModel& model, const PointOrder& order, f foca
 #   pragma clang diagnostic pop
 #endif
 
+// real roots of m^3 + a*m^2 + b*m + c = 0, only the largest one is returned
+static double cubic_max_root(double a, double b, double c)
+{
+    const double p = b - a*a/3, q = 2*a*a*a/27 - a*b/3 + c;
+    const double D = q*q/4 + p*p*p/27;
+    double t;
+
+    if (D >= 0)
+    {
+        const double sqrt_D = std::sqrt(D);
+        t = std::cbrt(-q/2 + sqrt_D) + std::cbrt(-q/2 - sqrt_D);
+    }
+    else
+    {
+        // three real roots, k=0 is the largest one
+        const double r = std::sqrt(-p/3);
+        t = 2 * r * std::cos(std::acos(std::clamp(-q/(2*r*r*r), -1., 1.))/3);
+    }
+
+    double m = t - a/3;
+
+    // polish, the closed form loses precision near multiple roots
+    for (int i = 0; i < 2; i++)
+    {
+        const double val = ((m + a)*m + b)*m + c, deriv = (3*m + 2*a)*m + b;
+        if (std::fabs(deriv) > 1e-30)
+            m -= val/deriv;
+    }
+
+    return m;
+}
+
+// real roots of c[0]*x^4 + c[1]*x^3 + c[2]*x^2 + c[3]*x + c[4] = 0 using Ferrari's method
+static unsigned solve_quartic(const double (&c)[5], double (&roots)[4])
+{
+    if (std::fabs(c[0]) < 1e-14)
+        return 0;
+
+    const double a = c[1]/c[0], b = c[2]/c[0], cc = c[3]/c[0], d = c[4]/c[0];
+    const double a2 = a*a;
+
+    // depressed quartic y^4 + p*y^2 + q*y + r = 0 with x = y - a/4
+    const double p = b - 3*a2/8,
+                 q = cc - a*b/2 + a2*a/8,
+                 r = d - a*cc/4 + a2*b/16 - 3*a2*a2/256;
+
+    double y[4];
+    unsigned n = 0;
+
+    auto quadratic = [&](double B, double C) {
+        double disc = B*B - 4*C;
+        if (disc < 0)
+        {
+            if (disc < -1e-12)
+                return;
+            disc = 0;
+        }
+        const double sqrt_disc = std::sqrt(disc);
+        y[n++] = (-B + sqrt_disc)/2;
+        y[n++] = (-B - sqrt_disc)/2;
+    };
+
+    if (std::fabs(q) < 1e-12)
+    {
+        // biquadratic
+        const double disc = p*p - 4*r;
+        if (disc < 0)
+            return 0;
+        const double sqrt_disc = std::sqrt(disc);
+        for (double z : { (-p + sqrt_disc)/2, (-p - sqrt_disc)/2 })
+            if (z >= 0)
+            {
+                y[n++] = std::sqrt(z);
+                y[n++] = -std::sqrt(z);
+            }
+    }
+    else
+    {
+        // resolvent cubic always has a positive root when q != 0
+        const double m = cubic_max_root(p, p*p/4 - r, -q*q/8);
+        if (!(m > 0))
+            return 0;
+        const double s = std::sqrt(2*m), h = q/(2*s);
+        quadratic(-s, p/2 + m + h);
+        quadratic(s, p/2 + m - h);
+    }
+
+    for (unsigned i = 0; i < n; i++)
+    {
+        double x = y[i] - a/4;
+        for (int k = 0; k < 2; k++)
+        {
+            const double val = (((c[0]*x + c[1])*x + c[2])*x + c[3])*x + c[4];
+            const double deriv = ((4*c[0]*x + 3*c[1])*x + 2*c[2])*x + c[3];
+            if (std::fabs(deriv) > 1e-30)
+                x -= val/deriv;
+        }
+        roots[i] = x;
+    }
+
+    return n;
+}
+
+// rotation taking the canonical basis to the frame spanned by d1, d2
+static cv::Matx33d orthonormal_frame(const cv::Vec3d& d1, const cv::Vec3d& d2)
+{
+    const cv::Vec3d e1 = cv::normalize(d1);
+    const cv::Vec3d e3 = cv::normalize(d1.cross(d2));
+    const cv::Vec3d e2 = e3.cross(e1);
+
+    return cv::Matx33d(e1[0], e2[0], e3[0],
+                       e1[1], e2[1], e3[1],
+                       e1[2], e2[2], e3[2]);
+}
+
+int PointTracker::P3P(const PointModel& model, const PointOrder& order, f focal_length)
+{
+    // Grunert's solution as presented in
+    // [Robert M. Haralick et al.: "Review and Analysis of Solutions of the Three Point Perspective Pose Estimation Problem"]
+    // we use the same notation as in the paper here, with the model points
+    // P_1 = 0, P_2 = M01, P_3 = M02
+
+    const cv::Vec3d M01 = model.M01, M02 = model.M02;
+
+    // unit vectors toward the image points
+    cv::Vec3d j[3];
+    for (unsigned i = 0; i < 3; i++)
+        j[i] = cv::normalize(cv::Vec3d(order[i][0], order[i][1], focal_length));
+
+    const double a2 = cv::norm(M01 - M02, cv::NORM_L2SQR),
+                 b2 = M02.dot(M02),
+                 c2 = M01.dot(M01);
+
+    if (b2 < 1e-8 || c2 < 1e-8 || a2 < 1e-8)
+        return -1;
+
+    const double cos_alpha = j[1].dot(j[2]),
+                 cos_beta  = j[0].dot(j[2]),
+                 cos_gamma = j[0].dot(j[1]);
+
+    const double amc = (a2 - c2)/b2, apc = (a2 + c2)/b2;
+    const double cos2_alpha = cos_alpha*cos_alpha,
+                 cos2_beta = cos_beta*cos_beta,
+                 cos2_gamma = cos_gamma*cos_gamma;
+
+    const double A[5] = {
+        (amc - 1)*(amc - 1) - 4*c2/b2*cos2_alpha,
+        4*(amc*(1 - amc)*cos_beta - (1 - apc)*cos_alpha*cos_gamma + 2*c2/b2*cos2_alpha*cos_beta),
+        2*(amc*amc - 1 + 2*amc*amc*cos2_beta + 2*(b2 - c2)/b2*cos2_alpha
+           - 4*apc*cos_alpha*cos_beta*cos_gamma + 2*(b2 - a2)/b2*cos2_gamma),
+        4*(-amc*(1 + amc)*cos_beta + 2*a2/b2*cos2_gamma*cos_beta - (1 - apc)*cos_alpha*cos_gamma),
+        (1 + amc)*(1 + amc) - 4*a2/b2*cos2_gamma,
+    };
+
+    double roots[4];
+    const unsigned nroots = solve_quartic(A, roots);
+
+    const cv::Matx33d R_expected = X_CM_expected.R;
+    const cv::Vec3d t_expected = X_CM_expected.t;
+    const cv::Matx33d F_model = orthonormal_frame(M01, M02);
+
+    cv::Matx33d R_best;
+    cv::Vec3d t_best;
+    double best_deviation = 0;
+    int ncandidates = 0;
+
+    for (unsigned i = 0; i < nroots; i++)
+    {
+        const double v = roots[i];
+        const double denom = 2*(cos_gamma - v*cos_alpha);
+
+        if (std::fabs(denom) < 1e-12)
+            continue;
+
+        const double u = ((amc - 1)*v*v - 2*amc*cos_beta*v + 1 + amc) / denom;
+        const double s1_sq = c2 / (1 + u*u - 2*u*cos_gamma);
+
+        if (!(s1_sq > 0) || u <= 0 || v <= 0)
+            continue;
+
+        const double s1 = std::sqrt(s1_sq);
+        const cv::Vec3d p1 = s1 * j[0], p2 = u*s1 * j[1], p3 = v*s1 * j[2];
+
+        const cv::Matx33d R = orthonormal_frame(p2 - p1, p3 - p1) * F_model.t();
+        const cv::Vec3d& t = p1;
+
+        // pick the solution closer to the expected pose,
+        // in the same rotation metric as POSIT
+        double deviation = cv::norm(cv::Matx33d::eye() - R_expected * R.t());
+        if (t_expected[2] > 1e-4)
+            deviation += cv::norm(t - t_expected) / t_expected[2];
+
+        if (ncandidates == 0 || deviation < best_deviation)
+        {
+            best_deviation = deviation;
+            R_best = R;
+            t_best = t;
+        }
+
+        ncandidates++;
+    }
+
+    if (ncandidates == 0)
+        return -1;
+
+    for (int i = 0; i < 3; i++)
+    {
+        for (int k = 0; k < 3; k++)
+        {
+            int ret = std::fpclassify(R_best(i, k));
+            if (ret == FP_NAN || ret == FP_INFINITE)
+            {
+                qDebug() << "p3p nan R";
+                return -1;
+            }
+        }
+
+        int ret = std::fpclassify(t_best[i]);
+        if (ret == FP_NAN || ret == FP_INFINITE)
+        {
+            qDebug() << "p3p nan T";
+            return -1;
+        }
+    }
+
+    X_CM.R = mat33(R_best);
+    X_CM.t = vec3(t_best);
+
+    X_CM_expected = X_CM;
+
+    return ncandidates;
+}
+
 vec2 PointTracker::project(const vec3& v_M, f focal_length)
 {
     return project(v_M, focal_length, X_CM);
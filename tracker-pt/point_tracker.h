@@ -53,6 +53,8 @@ struct PointModel final
 // Tracks a 3-point model
 // implementing the POSIT algorithm for coplanar points as presented in
 // [Denis Oberkampf, Daniel F. DeMenthon, Larry S. Davis: "Iterative Pose Estimation Using Coplanar Feature Points"]
+// or alternatively Grunert's closed-form P3P solution as presented in
+// [Robert M. Haralick et al.: "Review and Analysis of Solutions of the Three Point Perspective Pose Estimation Problem"]
 class PointTracker final
 {
 public:
@@ -60,7 +62,8 @@ public:
     // track the pose using the set of normalized point coordinates (x pos in range -0.5:0.5)
     // f : (focal length)/(sensor width)
     // dt : time since last call
-    void track(const std::vector<vec2>& projected_points, const PointModel& model, const pt_camera_info& info, int init_phase_timeout);
+    void track(const std::vector<vec2>& projected_points, const PointModel& model, const pt_camera_info& info,
+               int init_phase_timeout, pt_pose_solver solver = pt_solver_posit);
     Affine pose() const { return X_CM; }
     vec2 project(const vec3& v_M, f focal_length);
     vec2 project(const vec3& v_M, f focal_length, const Affine& X_CM);
@@ -74,6 +77,9 @@ private:
     PointOrder find_correspondences_previous(const vec2* points, const PointModel &model, const pt_camera_info& info);
     // The POSIT algorithm, returns the number of iterations
     int POSIT(const PointModel& point_model, const PointOrder& order, f focal_length);
+    // Closed-form P3P, returns the number of candidate poses or -1 on failure.
+    // The candidate closest to the expected pose is taken.
+    int P3P(const PointModel& point_model, const PointOrder& order, f focal_length);
 
     Affine X_CM;  // transform from model to camera
     Affine X_CM_expected;
@@ -21,6 +21,7 @@ f pt_camera_info::get_focal_length(f fov, int res_x, int res_y)
 
 pt_camera::pt_camera() = default;
 pt_camera::~pt_camera() = default;
+bool pt_camera::set_roi(int, int, int, int) { return false; }
 pt_runtime_traits::pt_runtime_traits() = default;
 pt_runtime_traits::~pt_runtime_traits() = default;
 pt_point_extractor::pt_point_extractor() = default;
@@ -77,6 +77,8 @@ struct pt_camera
 
     [[nodiscard]] virtual bool start(const QString& name, int fps, int res_x, int res_y) = 0;
     virtual void stop() = 0;
+    // false once the device stops delivering frames, until start() succeeds again
+    virtual bool is_open() const = 0;
 
     virtual result get_frame(pt_frame& frame) = 0;
     virtual result get_info() const = 0;
@@ -87,6 +89,10 @@ struct pt_camera
 
     virtual void set_fov(f value) = 0;
     virtual void show_camera_settings() = 0;
+
+    // crop on the device, in full field of view pixels; an empty rectangle
+    // goes back to the full field of view. False if the camera can't crop.
+    virtual bool set_roi(int x, int y, int w, int h);
 };
 
 struct pt_point_extractor : pt_pixel_pos_mixin
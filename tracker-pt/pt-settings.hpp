@@ -21,6 +21,21 @@ enum pt_color_type
     pt_color_magenta_chromakey = 13,
 };
 
+enum pt_pose_solver
+{
+    // explicit values, stored in .ini
+    pt_solver_posit = 0,
+    pt_solver_p3p = 1,
+};
+
+enum pt_detect_decimation
+{
+    // values are the decimation factor
+    pt_decimate_none = 1,
+    pt_decimate_2x = 2,
+    pt_decimate_4x = 4,
+};
+
 namespace pt_impl {
 
 using namespace options;
@@ -35,6 +50,7 @@ struct pt_settings final : options::opts
     using slider_value = options::slider_value;
 
     value<QString> camera_name { b, "camera-name", "" };
+    value<QString> camera_id { b, "camera-id", "" };
     value<int> cam_res_x { b, "camera-res-width", 640 },
                cam_res_y { b, "camera-res-height", 480 },
                cam_fps { b, "camera-fps", 30 };
@@ -64,6 +80,10 @@ struct pt_settings final : options::opts
     value<int> init_phase_timeout { b, "init-phase-timeout", 250 };
     value<bool> auto_threshold { b, "automatic-threshold", true };
     value<pt_color_type> blob_color { b, "blob-color", pt_color_natural };
+    value<pt_pose_solver> pose_solver { b, "pose-solver", pt_solver_posit };
+    value<pt_detect_decimation> detect_decimation { b, "detection-decimation", pt_decimate_none };
+    value<int> extraction_threads { b, "extraction-threads", 1 };
+    value<bool> camera_roi { b, "camera-roi", false };
 
     value<slider_value> threshold_slider { b, "threshold-slider", { 128, 0, 255 } };
 
@@ -8,14 +8,27 @@
 
 #include "ftnoir_tracker_udp.h"
 #include "api/plugin-api.hpp"
+#include "compat/thread-name.hpp"
 
+#include <chrono>
 #include <cmath>
+#include <cstring>
 #include <iterator>
 
-udp::udp() :
-    last_recv_pose { 0,0,0, 0,0,0 },
-    last_recv_pose2 { 0,0,0, 0,0,0 }
-{}
+#include <QDebug>
+
+#ifdef __linux__
+#   include <cerrno>
+#   include <poll.h>
+#   include <sys/socket.h>
+#endif
+
+// short enough for interruption to be noticed quickly on an idle socket
+static constexpr int poll_timeout_ms = 73;
+// packets further back than this are taken as the sender having restarted
+static constexpr int32_t reorder_window = 256;
+
+udp::udp() = default;
 
 udp::~udp()
 {
@@ -23,49 +36,156 @@ udp::~udp()
     wait();
 }
 
+// one byte bigger than any valid datagram, so that oversized ones don't match by being truncated
+union datagram_buffer
+{
+    char bytes[sizeof(udp_packet::extended) + 1];
+    udp_packet::extended packet;
+};
+
+static uint64_t time_us()
+{
+    using namespace std::chrono;
+    return (uint64_t)duration_cast<microseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+bool udp::accept_datagram(const char* buf, qint64 sz, uint64_t now_us)
+{
+    double pose[6];
+
+    if (sz == sizeof(double[6]))
+        memcpy(pose, buf, sizeof(pose));
+    else if (sz == sizeof(udp_packet::extended))
+    {
+        udp_packet::extended packet;
+        memcpy(&packet, buf, sizeof(packet));
+
+        if (packet.magic != udp_packet::extended::magic_value)
+            return false;
+
+        stats.packets++;
+
+        if (stats.has_sequence)
+        {
+            const auto delta = int32_t(packet.sequence - stats.last_sequence);
+            if (delta <= 0 && delta > -reorder_window)
+            {
+                // older than what we already have, or duplicated
+                stats.reordered++;
+                return false;
+            }
+            // otherwise it's either newer or the sender restarted its sequence
+            if (delta > 0)
+                stats.lost += unsigned(delta - 1);
+        }
+        stats.has_sequence = true;
+        stats.last_sequence = packet.sequence;
+
+        // only meaningful when both clocks are synchronized
+        const double latency_ms = (double)int64_t(now_us - packet.timestamp_us) * 1e-3;
+        stats.latency_sum_ms += latency_ms;
+        stats.latency_max_ms = std::fmax(stats.latency_max_ms, latency_ms);
+        stats.latency_count++;
+
+        memcpy(pose, packet.pose, sizeof(pose));
+    }
+    else
+        return false;
+
+    for (unsigned i = 0; i < 6; i++)
+    {
+        int val = std::fpclassify(pose[i]);
+        if (val == FP_NAN || val == FP_INFINITE)
+            return false;
+    }
+
+    memcpy(pending_pose, pose, sizeof(pose));
+    return true;
+}
+
+void udp::publish_pose()
+{
+    last_recv_pose.store(pending_pose);
+}
+
 void udp::run()
 {
-    QByteArray datagram;
-    datagram.resize(sizeof(last_recv_pose));
+    portable::set_curthread_name("tracker/udp");
+
+#ifdef __linux__
+    // batch receive on the native descriptor, Qt has no event loop on this thread anyway
+    const int fd = (int)sock.socketDescriptor();
+
+    constexpr unsigned batch_size = 32;
+    datagram_buffer bufs[batch_size];
+    iovec iov[batch_size];
+    mmsghdr msgs[batch_size] {};
+
+    for (unsigned i = 0; i < batch_size; i++)
+    {
+        iov[i] = { bufs[i].bytes, sizeof(bufs[i].bytes) };
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
 
     while (!isInterruptionRequested())
     {
-        if (sock.hasPendingDatagrams())
+        pollfd pfd { fd, POLLIN, 0 };
+        int ret = poll(&pfd, 1, poll_timeout_ms);
+
+        if (ret == -1 && errno != EINTR)
         {
-            QMutexLocker foo(&mutex);
+            qDebug() << "udp: poll" << errno;
+            break;
+        }
+        if (ret <= 0)
+            continue;
 
-            bool ok = false;
+        bool ok = false;
 
-            do
-            {
-                const qint64 sz = sock.readDatagram(reinterpret_cast<char*>(last_recv_pose2), sizeof(double[6]));
-                if (sz > 0)
-                    ok = true;
-            }
-            while (sock.hasPendingDatagrams());
+        for (;;)
+        {
+            int n = recvmmsg(fd, msgs, batch_size, MSG_DONTWAIT, nullptr);
+            if (n <= 0)
+                break;
 
-            if (ok)
-            {
-                for (unsigned i = 0; i < 6; i++)
-                {
-                    int val = std::fpclassify(last_recv_pose2[i]);
-                    if (val == FP_NAN || val == FP_INFINITE)
-                    {
-                        ok = false;
-                        break;
-                    }
-                }
-            }
+            const uint64_t now = time_us();
+            for (int i = 0; i < n; i++)
+                ok |= accept_datagram(bufs[i].bytes, msgs[i].msg_len, now);
 
-            if (ok)
-            {
-                for (unsigned i = 0; i < 6; i++)
-                    last_recv_pose[i] = last_recv_pose2[i];
-            }
+            if (unsigned(n) < batch_size)
+                break;
         }
 
-        (void) sock.waitForReadyRead(73);
+        if (ok)
+            publish_pose();
+    }
+#else
+    datagram_buffer buf;
+
+    while (!isInterruptionRequested())
+    {
+        bool ok = false;
+
+        while (sock.hasPendingDatagrams())
+        {
+            const qint64 sz = sock.readDatagram(buf.bytes, sizeof(buf.bytes));
+            ok |= accept_datagram(buf.bytes, sz, time_us());
+        }
+
+        if (ok)
+            publish_pose();
+
+        (void) sock.waitForReadyRead(poll_timeout_ms);
     }
+#endif
+
+    if (stats.packets > 0)
+        qDebug() << "udp: extended packets" << stats.packets
+                 << "lost" << stats.lost
+                 << "reordered" << stats.reordered
+                 << "latency ms avg" << stats.latency_sum_ms / stats.latency_count
+                 << "max" << stats.latency_max_ms;
 }
 
 module_status udp::start_tracker(QFrame*)
@@ -81,9 +201,7 @@ module_status udp::start_tracker(QFrame*)
 
 void udp::data(double *data)
 {
-    QMutexLocker foo(&mutex);
-    for (int i = 0; i < 6; i++)
-        data[i] = last_recv_pose[i];
+    last_recv_pose.load(data);
 
     int values[] = {
         0,
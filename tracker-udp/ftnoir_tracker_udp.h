@@ -5,6 +5,8 @@
 #include <cmath>
 #include "api/plugin-api.hpp"
 #include "options/options.hpp"
+#include "compat/seqlock.hpp"
+#include "compat/udp-packet.hpp"
 using namespace options;
 
 struct settings : opts {
@@ -30,10 +32,23 @@ public:
 protected:
     void run() override;
 private:
+    bool accept_datagram(const char* buf, qint64 sz, uint64_t now_us);
+    void publish_pose();
+
     QUdpSocket sock;
-    double last_recv_pose[6], last_recv_pose2[6];
-    QMutex mutex;
+    // newest valid pose, written by run() and read by data()
+    seqlock_slot<6> last_recv_pose;
+    double pending_pose[6] {};
     settings s;
+
+    // receive statistics, logged when the thread exits
+    struct {
+        uint64_t packets = 0, lost = 0, reordered = 0;
+        uint32_t last_sequence = 0;
+        bool has_sequence = false;
+        double latency_sum_ms = 0, latency_max_ms = 0;
+        uint64_t latency_count = 0;
+    } stats;
 };
 
 class dialog_udp: public ITrackerDialog
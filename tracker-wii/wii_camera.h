@@ -32,6 +32,7 @@ struct WIICamera final : pt_camera
 
     bool start(const QString& name, int fps, int res_x, int res_y) override;
     void stop() override;
+    bool is_open() const override { return m_pDev != nullptr; }
 
     result get_frame(pt_frame& Frame) override;
     result get_info() const override;
@@ -1,7 +1,12 @@
 #include "impl.hpp"
 #include "compat/sleep.hpp"
+#include "compat/thread-name.hpp"
 #include "video-property-page.hpp"
 
+#include <chrono>
+
+#include <QDebug>
+
 namespace opencv_camera_impl {
 
 cam::cam(int idx) : idx(idx)
@@ -15,14 +20,22 @@ cam::~cam()
 
 void cam::stop()
 {
+    if (grabber.joinable())
+    {
+        grabbing = false;
+        grabber.join();
+        qDebug() << "video/opencv: dropped" << dropped << "of" << seq << "frames";
+    }
     if (cap)
     {
         if (cap->isOpened())
             cap->release();
         cap = std::nullopt;
     }
-    mat = cv::Mat();
+    mat = cv::Mat(); latest = cv::Mat(); grabbed = cv::Mat();
+    seq = 0; seq_read = 0; dropped = 0;
     frame_ = { {}, false };
+    raw_mjpeg = false;
 }
 
 bool cam::is_open()
@@ -46,6 +59,15 @@ bool cam::start(info& args)
     if (!cap->isOpened())
         goto fail;
 
+#ifdef __linux__
+    if (args.accept_luma && video::mjpeg_decoder::is_available() &&
+        (int)cap->get(cv::CAP_PROP_FOURCC) == cv::VideoWriter::fourcc('M', 'J', 'P', 'G'))
+        raw_mjpeg = cap->set(cv::CAP_PROP_CONVERT_RGB, 0);
+#endif
+
+    grabbing = true;
+    grabber = std::thread(&cam::grab_loop, this);
+
     if (!get_frame_())
         goto fail;
 
@@ -56,6 +78,53 @@ fail:
     return false;
 }
 
+void cam::grab_loop()
+{
+    portable::set_curthread_name("video/opencv grab");
+
+    while (grabbing.load(std::memory_order_relaxed))
+    {
+        bool ok;
+        {
+            std::lock_guard l(cap_mtx);
+            ok = cap->read(grabbed);
+        }
+        // OpenCV doesn't pass the driver's timestamp through, this is the closest we get
+        const auto timestamp_ns = (std::uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+
+        if (!ok)
+        {
+            portable::sleep(50);
+            continue;
+        }
+
+        {
+            std::lock_guard l(frame_mtx);
+            if (seq != seq_read)
+                dropped++;
+            std::swap(grabbed, latest);
+            latest_timestamp_ns = timestamp_ns;
+            seq++;
+        }
+        frame_cv.notify_one();
+    }
+}
+
+bool cam::wait_for_frame(int timeout_ms)
+{
+    std::unique_lock l(frame_mtx);
+
+    if (!frame_cv.wait_for(l, std::chrono::milliseconds(timeout_ms), [this] { return seq != seq_read; }))
+        return false;
+
+    std::swap(mat, latest);
+    frame_.timestamp_ns = latest_timestamp_ns;
+    seq_read = seq;
+
+    return true;
+}
+
 bool cam::get_frame_()
 {
     if (!is_open())
@@ -63,8 +132,22 @@ bool cam::get_frame_()
 
     for (unsigned i = 0; i < 10; i++)
     {
-        if (cap->read(mat))
+        if (wait_for_frame(50))
         {
+            if (raw_mjpeg && mat.rows == 1 && mat.isContinuous())
+            {
+                if (mjpeg.decode_luma(mat.data, mat.total() * mat.elemSize(), frame_))
+                    return true;
+                // corrupt frame, try the next one
+                continue;
+            }
+            else if (raw_mjpeg)
+            {
+                // the backend ignored CONVERT_RGB and decoded the frame itself
+                qDebug() << "video/opencv: no raw mjpeg from the backend";
+                raw_mjpeg = false;
+            }
+
             frame_.data = mat.data;
             frame_.width = mat.cols;
             frame_.height = mat.rows;
@@ -76,7 +159,6 @@ bool cam::get_frame_()
 
             return true;
         }
-        portable::sleep(50);
     }
 
     return false;
@@ -91,7 +173,10 @@ std::tuple<const frame&, bool> cam::get_frame()
 bool cam::show_dialog()
 {
     if (is_open())
+    {
+        std::lock_guard l(cap_mtx);
         return video_property_page::show_from_capture(*cap, idx);
+    }
     else
         return video_property_page::show(idx);
 }
@@ -32,6 +32,16 @@ bool metadata::can_show_dialog(const QString& camera_name)
     return camera_name_to_index(camera_name) != -1;
 }
 
+QString metadata::camera_id(const QString& camera_name) const
+{
+    // same device as camera_name_to_index() picks, the first one by that name
+    for (const camera_device& dev : get_camera_devices())
+        if (dev.name == camera_name)
+            return dev.bus_path.isEmpty() ? QString() : QStringLiteral("opencv:%1").arg(dev.bus_path);
+
+    return {};
+}
+
 bool metadata::show_dialog(const QString& camera_name)
 {
     int idx = camera_name_to_index(camera_name);
@@ -8,8 +8,13 @@
 #pragma once
 
 #include "video/camera.hpp"
+#include "video/mjpeg.hpp"
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
 #include <optional>
+#include <thread>
 
 #include <opencv2/core.hpp>
 #include <opencv2/videoio.hpp>
@@ -27,6 +32,7 @@ struct metadata : camera_
     std::unique_ptr<camera> make_camera(const QString& name) override;
     bool can_show_dialog(const QString& camera_name) override;
     bool show_dialog(const QString& camera_name) override;
+    QString camera_id(const QString& camera_name) const override;
 };
 
 struct cam final : camera
@@ -50,11 +56,26 @@ static constexpr int video_capture_backend =
     bool show_dialog() override;
 
     bool get_frame_();
+    bool wait_for_frame(int timeout_ms);
+    void grab_loop();
 
     std::optional<cv::VideoCapture> cap;
-    cv::Mat mat;
+
+    // the grab thread reads into `grabbed', then swaps it with `latest';
+    // get_frame() swaps `latest' into `mat', so no buffer is ever shared
+    std::thread grabber;
+    std::atomic<bool> grabbing = false;
+    std::mutex cap_mtx, frame_mtx;
+    std::condition_variable frame_cv;
+    cv::Mat mat, latest, grabbed;
+    std::uint64_t latest_timestamp_ns = 0;
+    unsigned seq = 0, seq_read = 0, dropped = 0;
+
+    video::mjpeg_decoder mjpeg;
     frame frame_;
     int idx = -1;
+    // compressed frames come out of the driver as-is, only luma gets decoded
+    bool raw_mjpeg = false;
 };
 
 } // ns opencv_camera_impl
@@ -0,0 +1,83 @@
+#pragma once
+
+// Wakes the tracker when the driver process publishes a frame. Header-only
+// since the driver process doesn't link against compat.
+
+#include <atomic>
+#include <cstdint>
+
+#if defined __linux__
+#   include <climits>
+#   include <ctime>
+#   include <linux/futex.h>
+#   include <sys/syscall.h>
+#   include <unistd.h>
+#elif defined _WIN32
+#   include <windows.h>
+#else
+#   include <chrono>
+#   include <thread>
+#endif
+
+namespace ps3eye {
+
+class frame_signal final
+{
+#if defined __linux__
+    // shared futex on the timecode word itself, works across processes
+    static long futex(std::atomic<uint32_t>& word, int op, uint32_t val, const timespec* timeout)
+    {
+        return syscall(SYS_futex, (uint32_t*)&word, op, val, timeout, nullptr, 0);
+    }
+#elif defined _WIN32
+    // WaitOnAddress() doesn't work across processes
+    HANDLE event = CreateEventA(nullptr, false, false, "ps3eye-driver-frame");
+#endif
+
+public:
+    frame_signal() = default;
+    frame_signal(const frame_signal&) = delete;
+    frame_signal& operator=(const frame_signal&) = delete;
+
+    ~frame_signal()
+    {
+#ifdef _WIN32
+        if (event)
+            CloseHandle(event);
+#endif
+    }
+
+    // returns once `word` differs from `seen`, on timeout or spuriously
+    void wait(std::atomic<uint32_t>& word, uint32_t seen, int timeout_ms)
+    {
+        if (word.load(std::memory_order_acquire) != seen)
+            return;
+#if defined __linux__
+        const timespec ts { timeout_ms / 1000, (timeout_ms % 1000) * 1000000L };
+        (void)futex(word, FUTEX_WAIT, seen, &ts);
+#elif defined _WIN32
+        if (event)
+            (void)WaitForSingleObject(event, (DWORD)timeout_ms);
+        else
+            Sleep(1);
+#else
+        (void)timeout_ms;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+#endif
+    }
+
+    void wake(std::atomic<uint32_t>& word)
+    {
+#if defined __linux__
+        (void)futex(word, FUTEX_WAKE, INT_MAX, nullptr);
+#elif defined _WIN32
+        (void)word;
+        if (event)
+            SetEvent(event);
+#else
+        (void)word;
+#endif
+    }
+};
+
+} // ns ps3eye
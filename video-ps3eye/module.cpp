@@ -126,9 +126,16 @@ ps3eye_camera::~ps3eye_camera()
     stop();
 }
 
+void ps3eye_camera::release_slot()
+{
+    if (shm.success())
+        ((ps3eye::shm*)shm.ptr())->in.reader_slot.store(ps3eye::shm_out::no_slot);
+}
+
 void ps3eye_camera::stop()
 {
     open = false;
+    release_slot();
 
     if (wrapper.state() != QProcess::NotRunning)
     {
@@ -149,6 +156,9 @@ bool ps3eye_camera::start(info& args)
     using mode = ps3eye::shm_in::mode;
 
     open = false;
+    timecode = 0;
+    ptr.out.timecode.store(0);
+    release_slot();
     fr = {};
     fr.channels = 3;
     fr.channel_size = 1;
@@ -169,8 +179,6 @@ bool ps3eye_camera::start(info& args)
     ptr.in.gain = (uint8_t)s.gain;
     ptr.in.exposure = (uint8_t)s.exposure;
 
-    sleep_ms = std::clamp(int(std::floor(1000./ptr.in.framerate*2)), 1, 10);
-
     wrapper.start();
 
     constexpr int sleep_ms = 10, max_sleeps = 5000/sleep_ms;
@@ -201,40 +209,45 @@ ok:
 
 std::tuple<const frame&, bool> ps3eye_camera::get_frame()
 {
-    auto volatile* ptr = (ps3eye::shm*)shm.ptr();
+    constexpr int timeout_ms = 2000;
 
-    if (shm.success() && open)
-    {
-        int elapsed = std::min((int)std::ceil(t.elapsed_ms()), 100);
-        portable::sleep(sleep_ms - elapsed);
+    if (!shm.success() || !open)
+        return { fr, false };
 
-        if (unsigned tc = ptr->out.timecode; tc != timecode)
-        {
-            timecode = tc;
-            goto ok;
-        }
-    }
+    auto& out = ((ps3eye::shm*)shm.ptr())->out;
+    auto& reader = ((ps3eye::shm*)shm.ptr())->in.reader_slot;
+    Timer t;
 
-    for (int i = 0; i < 2000; i++)
+    // the previous frame stays readable until we get here
+    while (t.elapsed_ms() < timeout_ms)
     {
-        if (unsigned tc = ptr->out.timecode; tc != timecode)
+        const unsigned tc = out.timecode.load();
+
+        if (tc == timecode)
         {
-            timecode = tc;
-            goto ok;
+            signal.wait(out.timecode, tc, std::max(1, timeout_ms - (int)t.elapsed_ms()));
+            continue;
         }
-        portable::sleep(1);
+
+        const unsigned idx = out.latest_slot.load();
+        if (idx >= ps3eye::shm_out::slot_count)
+            continue;
+
+        // pairs with the driver claiming a slot and then checking reader_slot
+        reader.store(idx);
+        const unsigned slot_tc = out.slots[idx].timecode.load();
+
+        // overwritten after we looked it up, the next one is already published
+        if (slot_tc == 0 || slot_tc == timecode)
+            continue;
+
+        timecode = slot_tc;
+        fr.data = out.slots[idx].data;
+        return { fr, true };
     }
 
     stop();
     return { fr, false };
-
-    static_assert(offsetof(decltype(ptr->out), data_640x480) == offsetof(decltype(ptr->out), data_320x240));
-
-ok:
-    t.start();
-    memcpy(data, (unsigned char*)ptr->out.data_640x480,sizeof(ptr->out.data_640x480));
-    fr.data = data;
-    return { fr, true };
 }
 
 bool ps3eye_camera::show_dialog()
@@ -2,6 +2,7 @@
 
 #include "video/camera.hpp"
 #include "shm-layout.hpp"
+#include "frame-signal.hpp"
 #include "compat/shm.h"
 #include "options/options.hpp"
 #include "compat/macros1.h"
@@ -52,13 +53,13 @@ struct ps3eye_camera final : video::impl::camera
     QProcess wrapper;
     shm_wrapper shm { "ps3eye-driver-shm", nullptr, sizeof(ps3eye::shm) };
     settings s;
+    ps3eye::frame_signal signal;
     frame fr;
-    Timer t;
-    unsigned char data[640 * 480 * 3] = {};
-    int framerate = 30, sleep_ms = 1;
     bool open = false;
     unsigned timecode = 0;
 
+    void release_slot();
+
     ps3eye_camera();
     ~ps3eye_camera() override;
 
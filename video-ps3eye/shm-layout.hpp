@@ -1,5 +1,6 @@
 #pragma once
 #include <cstdint>
+#include <atomic>
 
 namespace ps3eye {
 
@@ -12,22 +13,36 @@ struct shm_in {
     //uint8_t sharpness, contrast, brightness hue, saturation;
     uint8_t gain, exposure, auto_gain, test_pattern;
     uint8_t do_exit;
+
+    // slot the tracker is reading in place, the driver never writes into it
+    std::atomic<uint32_t> reader_slot;
 };
 
 struct shm_out
 {
     enum class status : uint8_t { starting, running, fail, terminate, };
 
-    uint32_t timecode;
+    // the driver's slot, the tracker's slot and the newest frame are always distinct
+    static constexpr unsigned slot_count = 3;
+    static constexpr uint32_t no_slot = ~0u;
+
+    struct alignas(64) slot
+    {
+        std::atomic<uint32_t> timecode; // zero while the driver is writing
+        uint8_t data[640 * 480 * 3];    // QVGA frames use the beginning
+    };
+
+    std::atomic<uint32_t> timecode;     // last published frame, the wakeup word
+    std::atomic<uint32_t> latest_slot;
     uint32_t settings_updated_ack;
     status status_;
     char error_string[256];
-    union {
-        uint8_t data_320x240[320][240][3];
-        uint8_t data_640x480[640][480][3];
-    };
+    slot slots[slot_count];
 };
 
+static_assert(std::atomic<uint32_t>::is_always_lock_free);
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t));
+
 struct shm {
     static constexpr unsigned _cacheline_len = 64;
     static constexpr unsigned _padding_len =
@@ -1,5 +1,6 @@
 #include "shm-layout.hpp"
 #include "shm.hpp"
+#include "frame-signal.hpp"
 
 #include "ps3eye-driver/ps3eye.hpp"
 
@@ -45,13 +46,35 @@ static ps3eye::resolution get_mode(ps3eye::shm_in::mode res)
     }
 }
 
+static unsigned claim_slot(ps3eye::shm& mem)
+{
+    auto& out = mem.out;
+    auto& reader = mem.in.reader_slot;
+
+    for (;;)
+    {
+        const uint32_t latest = out.latest_slot.load(), busy = reader.load();
+        unsigned idx = 0;
+        while (idx == latest || idx == busy)
+            idx++;
+
+        // pairs with the tracker storing reader_slot and then checking the timecode
+        auto& slot = out.slots[idx];
+        const uint32_t old = slot.timecode.exchange(0);
+        if (reader.load() != idx)
+            return idx;
+        slot.timecode.store(old);
+    }
+}
+
 int main(int argc, char** argv)
 {
     (void)argc; (void)argv;
     shm_wrapper mem_("ps3eye-driver-shm", nullptr, sizeof(ps3eye::shm));
-    volatile auto& ptr_ = *(ps3eye::shm*)mem_.ptr();
-    volatile auto& in = ptr_.in;
-    volatile auto& out = ptr_.out;
+    auto& mem = *(ps3eye::shm*)mem_.ptr();
+    volatile auto& in = mem.in;
+    volatile auto& out = mem.out;
+    ps3eye::frame_signal signal;
 
     auto cameras = ps3eye::list_devices();
 
@@ -62,8 +85,7 @@ int main(int argc, char** argv)
 
     auto& camera = cameras[0];
     camera->set_debug(false);
-    auto* frame = (uint8_t*)out.data_640x480;
-    decltype(out.timecode) timecode = 0;
+    uint32_t timecode = 0;
 
     {
         int framerate = in.framerate;
@@ -79,7 +101,10 @@ int main(int argc, char** argv)
             error(out, "can't start camera: %s", camera->error_string());
     }
 
-    out.timecode = 0;
+    for (auto& slot : mem.out.slots)
+        slot.timecode.store(0);
+    mem.out.latest_slot.store(ps3eye::shm_out::no_slot);
+    mem.out.timecode.store(0);
     in.do_exit = false;
     std::atomic_thread_fence(std::memory_order_seq_cst);
 
@@ -102,15 +127,23 @@ int main(int argc, char** argv)
             }
         }
 
-        if (!camera->get_frame(frame))
+        const unsigned idx = claim_slot(mem);
+        auto& slot = mem.out.slots[idx];
+
+        if (!camera->get_frame(slot.data))
             continue;
 
-        out.timecode = ++timecode;
+        // zero marks a slot being written
+        if (++timecode == 0)
+            timecode = 1;
+
+        slot.timecode.store(timecode);
+        mem.out.latest_slot.store(idx);
+        mem.out.timecode.store(timecode);
+        signal.wake(mem.out.timecode);
 
         if (in.do_exit)
             break;
-
-        std::atomic_thread_fence(std::memory_order_seq_cst);
     }
 
     return 0;
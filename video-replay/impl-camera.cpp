@@ -0,0 +1,97 @@
+#include "impl.hpp"
+#include "compat/math.hpp"
+#include "compat/sleep.hpp"
+
+namespace replay_camera_impl {
+
+cam::cam() = default;
+
+cam::~cam()
+{
+    stop();
+}
+
+bool cam::is_open()
+{
+    return open;
+}
+
+void cam::stop()
+{
+    reader.close();
+    frame_ = {};
+    pos = 0;
+    open = false;
+}
+
+bool cam::start(info& args)
+{
+    stop();
+
+    if (!reader.open(*s.filename))
+        return false;
+
+    paced = s.paced;
+    loop = s.loop;
+
+    frame fr;
+    std::uint64_t ts_first = 0, ts_last = 0;
+    const unsigned n = reader.frame_count();
+
+    (void)reader.get(0, fr, ts_first);
+    (void)reader.get(n - 1, fr, ts_last);
+
+    // the recording decides, whatever the tracker asked for
+    args.width = fr.width;
+    args.height = fr.height;
+    if (n > 1 && ts_last > ts_first)
+        args.fps = iround((n - 1) * 1e9 / double(ts_last - ts_first));
+
+    open = true;
+    return true;
+}
+
+std::tuple<const frame&, bool> cam::get_frame()
+{
+    if (!open)
+        return { frame_, false };
+
+    if (pos >= reader.frame_count())
+    {
+        if (!loop)
+        {
+            portable::sleep(100);
+            return { frame_, false };
+        }
+        pos = 0;
+    }
+
+    std::uint64_t ts = 0;
+
+    if (!reader.get(pos, frame_, ts))
+        return { frame_, false };
+
+    if (pos == 0)
+    {
+        t.start();
+        first_timestamp = ts;
+    }
+    else if (paced)
+    {
+        const double wait_ms = (ts - first_timestamp) * 1e-6 - t.elapsed_ms();
+        if (wait_ms >= 1)
+            portable::sleep(int(wait_ms));
+    }
+
+    pos++;
+
+    return { frame_, true };
+}
+
+bool cam::show_dialog()
+{
+    (new dialog)->show();
+    return true;
+}
+
+} // ns replay_camera_impl
@@ -0,0 +1,27 @@
+#include "impl.hpp"
+
+#include <QFileDialog>
+
+namespace replay_camera_impl {
+
+dialog::dialog(QWidget* parent) : QWidget(parent)
+{
+    ui.setupUi(this);
+
+    tie_setting(s.filename, ui.filename);
+    tie_setting(s.paced, ui.paced);
+    tie_setting(s.loop, ui.loop);
+
+    connect(ui.browse, &QPushButton::clicked, this, &dialog::browse);
+    connect(ui.buttonBox, &QDialogButtonBox::accepted, this, &dialog::do_ok);
+    connect(ui.buttonBox, &QDialogButtonBox::rejected, this, &dialog::do_cancel);
+}
+
+void dialog::browse()
+{
+    QString name = QFileDialog::getOpenFileName(this, tr("Open recording"), *s.filename);
+    if (!name.isEmpty())
+        s.filename = name;
+}
+
+} // ns replay_camera_impl
@@ -0,0 +1,38 @@
+#include "impl.hpp"
+
+namespace replay_camera_impl {
+
+static const QString camera_name = QStringLiteral("Recorded video");
+
+metadata::metadata() = default;
+
+std::vector<QString> metadata::camera_names() const
+{
+    return { camera_name };
+}
+
+std::unique_ptr<camera> metadata::make_camera(const QString& name)
+{
+    if (name == camera_name)
+        return std::make_unique<cam>();
+    else
+        return nullptr;
+}
+
+bool metadata::can_show_dialog(const QString& name)
+{
+    return name == camera_name;
+}
+
+bool metadata::show_dialog(const QString& name)
+{
+    if (name != camera_name)
+        return false;
+
+    (new dialog)->show();
+    return true;
+}
+
+OTR_REGISTER_CAMERA(metadata)
+
+} // ns replay_camera_impl
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "video/camera.hpp"
+#include "video/recording.hpp"
+#include "options/options.hpp"
+#include "compat/timer.hpp"
+#include "ui_dialog.h"
+
+#include <cstdint>
+
+#include <QWidget>
+
+namespace replay_camera_impl {
+
+using namespace video::impl;
+using namespace options;
+
+struct settings final
+{
+    bundle b = make_bundle("video-replay");
+    value<QString> filename { b, "filename", {} };
+    value<bool> paced { b, "paced", true };
+    value<bool> loop { b, "loop", true };
+};
+
+struct metadata : camera_
+{
+    metadata();
+    std::vector<QString> camera_names() const override;
+    std::unique_ptr<camera> make_camera(const QString& name) override;
+    bool can_show_dialog(const QString& camera_name) override;
+    bool show_dialog(const QString& camera_name) override;
+};
+
+struct cam final : camera
+{
+    cam();
+    ~cam() override;
+
+    bool start(info& args) override;
+    void stop() override;
+    bool is_open() override;
+    std::tuple<const frame&, bool> get_frame() override;
+    bool show_dialog() override;
+
+private:
+    settings s;
+    video::recording::reader reader;
+    frame frame_;
+    Timer t;
+    std::uint64_t first_timestamp = 0;
+    unsigned pos = 0;
+    bool open = false, paced = true, loop = true;
+};
+
+class dialog final : public QWidget
+{
+    Q_OBJECT
+    Ui_replay_dialog ui;
+    settings s;
+
+    void browse();
+    void do_ok() { s.b->save(); close(); deleteLater(); }
+    void do_cancel() { s.b->reload(); close(); deleteLater(); }
+
+protected:
+    void closeEvent(QCloseEvent*) override { do_cancel(); }
+
+public:
+    explicit dialog(QWidget* parent = nullptr);
+};
+
+} // ns replay_camera_impl
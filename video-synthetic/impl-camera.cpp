@@ -0,0 +1,232 @@
+#include "impl.hpp"
+#include "compat/math.hpp"
+#include "compat/math-imports.hpp"
+#include "compat/sleep.hpp"
+
+#include <algorithm>
+
+#include <opencv2/imgproc.hpp>
+
+#include <QTextStream>
+
+namespace synthetic_camera_impl {
+
+static constexpr double blur_sigma = .8;
+static constexpr unsigned char background = 8;
+
+static cv::Matx33d euler_to_rmat(double yaw, double pitch, double roll)
+{
+    const double cy = cos(yaw), sy = sin(yaw);
+    const double cp = cos(pitch), sp = sin(pitch);
+    const double cr = cos(roll), sr = sin(roll);
+
+    const cv::Matx33d Ry(cy, 0, sy,
+                         0, 1, 0,
+                         -sy, 0, cy);
+    const cv::Matx33d Rx(1, 0, 0,
+                         0, cp, -sp,
+                         0, sp, cp);
+    const cv::Matx33d Rz(cr, -sr, 0,
+                         sr, cr, 0,
+                         0, 0, 1);
+
+    return Ry * Rx * Rz;
+}
+
+cam::cam() = default;
+
+cam::~cam()
+{
+    stop();
+}
+
+bool cam::is_open()
+{
+    return open;
+}
+
+void cam::stop()
+{
+    if (ground_truth.isOpen())
+        ground_truth.close();
+    distractors.clear();
+    frame_ = {};
+    open = false;
+}
+
+bool cam::start(info& args)
+{
+    stop();
+
+    const int w = args.width > 0 ? args.width : 640;
+    const int h = args.height > 0 ? args.height : 480;
+    fps = args.fps > 0 ? args.fps : 30;
+
+    args.width = w;
+    args.height = h;
+    args.fps = iround(fps);
+
+    luma = args.accept_luma;
+    paced = s.paced;
+
+    gray.create(h, w);
+    noise.create(h, w);
+
+    // same as pt_camera_info::get_focal_length(), in pixels
+    {
+        const double diag_fov = *pt.fov * M_PI / 180;
+        const double fov_x = 2 * atan(tan(diag_fov * .5) * w / sqrt(double(w*w + h*h)));
+        focal_length = .5 * w / tan(fov_x * .5);
+    }
+
+    // keep in sync with PointModel::set_model()
+    model[0] = { 0, 0, 0 };
+    switch (*pt.active_model_panel)
+    {
+    default:
+    case 0: // clip
+        model[1] = { 0, (double)pt.clip_ty, -(double)pt.clip_tz };
+        model[2] = { 0, -(double)pt.clip_by, -(double)pt.clip_bz };
+        break;
+    case 1: // cap
+        model[1] = { -(double)pt.cap_x, -(double)pt.cap_y, -(double)pt.cap_z };
+        model[2] = { (double)pt.cap_x, -(double)pt.cap_y, -(double)pt.cap_z };
+        break;
+    case 2: // custom
+        model[1] = { (double)pt.m01_x, (double)pt.m01_y, (double)pt.m01_z };
+        model[2] = { (double)pt.m02_x, (double)pt.m02_y, (double)pt.m02_z };
+        break;
+    }
+
+    // fixed seed, every run renders the same sequence
+    rng = cv::RNG(0x5eed);
+
+    for (int i = 0; i < std::max(0, *s.distractors); i++)
+        distractors.push_back({ rng.uniform(0.f, 1.f), rng.uniform(0.f, 1.f), rng.uniform(1.5f, 6.f) });
+
+    if (const QString filename = s.ground_truth; !filename.isEmpty())
+    {
+        ground_truth.setFileName(filename);
+        if (ground_truth.open(QFile::WriteOnly | QFile::Truncate | QFile::Text))
+            ground_truth.write("frame,time,r00,r01,r02,r10,r11,r12,r20,r21,r22,tx,ty,tz\n");
+        else
+            qDebug() << "synthetic camera: can't write" << filename << ground_truth.errorString();
+    }
+
+    frame_no = 0;
+    t.start();
+    open = true;
+
+    return true;
+}
+
+void cam::render(const cv::Matx33d& R, const cv::Vec3d& t)
+{
+    constexpr int shift = 4;
+    constexpr double scale = 1 << shift;
+
+    const int w = gray.cols, h = gray.rows;
+
+    gray.setTo(background);
+
+    for (const cv::Vec3d& p : model)
+    {
+        const cv::Vec3d v = R * p + t;
+
+        if (v[2] < 1)
+            continue;
+
+        // inverse of pt_pixel_pos_mixin::to_screen_pos()
+        const double px = (w * .5 + focal_length * v[0] / v[2]) * (w - 1) / w;
+        const double py = (h * .5 - focal_length * v[1] / v[2]) * (h - 1) / h;
+        const double radius = std::max(1., *s.led_radius * focal_length / v[2]);
+
+        cv::circle(gray, { iround(px * scale), iround(py * scale) }, iround(radius * scale),
+                   cv::Scalar(255), cv::FILLED, cv::LINE_AA, shift);
+    }
+
+    // specular reflections don't quite reach full brightness
+    for (const distractor& d : distractors)
+        cv::circle(gray, { iround(d.x * w * scale), iround(d.y * h * scale) }, iround(d.radius * scale),
+                   cv::Scalar(rng.uniform(160, 256)), cv::FILLED, cv::LINE_AA, shift);
+
+    cv::GaussianBlur(gray, gray, cv::Size(), blur_sigma);
+
+    if (const double stddev = *s.noise; stddev > 0)
+    {
+        rng.fill(noise, cv::RNG::NORMAL, 0, stddev);
+        cv::add(gray, noise, gray, cv::noArray(), CV_8U);
+    }
+}
+
+void cam::write_ground_truth(const cv::Matx33d& R, const cv::Vec3d& t)
+{
+    QTextStream out(&ground_truth);
+    out.setRealNumberPrecision(9);
+
+    out << frame_no << ',' << frame_no / fps;
+    for (unsigned i = 0; i < 9; i++)
+        out << ',' << R.val[i];
+    for (unsigned i = 0; i < 3; i++)
+        out << ',' << t[i];
+    out << '\n';
+}
+
+std::tuple<const frame&, bool> cam::get_frame()
+{
+    if (!open)
+        return { frame_, false };
+
+    const double time = frame_no / fps;
+
+    if (paced)
+    {
+        const double wait_ms = time * 1000 - t.elapsed_ms();
+        if (wait_ms >= 1)
+            portable::sleep(int(wait_ms));
+    }
+
+    // incommensurate periods so the trajectory doesn't repeat quickly
+    const double phase = 2 * M_PI * time / std::max(.1, *s.period);
+    const double deg = M_PI / 180;
+
+    const cv::Matx33d R = euler_to_rmat(*s.yaw_amplitude * deg * sin(phase),
+                                        *s.pitch_amplitude * deg * sin(phase / 1.3),
+                                        5 * deg * sin(phase / 1.7));
+    const cv::Vec3d T(40 * sin(phase / 1.1),
+                      25 * sin(phase / .9),
+                      *s.distance + 50 * sin(phase / 1.5));
+
+    render(R, T);
+
+    if (ground_truth.isOpen())
+        write_ground_truth(R, T);
+
+    frame_no++;
+
+    if (luma)
+    {
+        frame_.data = gray.data;
+        frame_.channels = 1;
+    }
+    else
+    {
+        cv::cvtColor(gray, color, cv::COLOR_GRAY2BGR);
+        frame_.data = color.data;
+        frame_.channels = 3;
+    }
+
+    frame_.width = gray.cols;
+    frame_.height = gray.rows;
+    frame_.stride = 0;
+
+    return { frame_, true };
+}
+
+bool cam::show_dialog()
+{
+    (new dialog)->show();
+    return true;
+}
+
+} // ns synthetic_camera_impl
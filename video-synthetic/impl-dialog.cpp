@@ -0,0 +1,23 @@
+#include "impl.hpp"
+
+namespace synthetic_camera_impl {
+
+dialog::dialog(QWidget* parent) : QWidget(parent)
+{
+    ui.setupUi(this);
+
+    tie_setting(s.distance, ui.distance);
+    tie_setting(s.yaw_amplitude, ui.yaw_amplitude);
+    tie_setting(s.pitch_amplitude, ui.pitch_amplitude);
+    tie_setting(s.period, ui.period);
+    tie_setting(s.led_radius, ui.led_radius);
+    tie_setting(s.noise, ui.noise);
+    tie_setting(s.distractors, ui.distractors);
+    tie_setting(s.paced, ui.paced);
+    tie_setting(s.ground_truth, ui.ground_truth);
+
+    connect(ui.buttonBox, &QDialogButtonBox::accepted, this, &dialog::do_ok);
+    connect(ui.buttonBox, &QDialogButtonBox::rejected, this, &dialog::do_cancel);
+}
+
+} // ns synthetic_camera_impl
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "video/camera.hpp"
+#include "tracker-pt/pt-settings.hpp"
+#include "options/options.hpp"
+#include "compat/timer.hpp"
+#include "ui_dialog.h"
+
+#include <vector>
+
+#include <QFile>
+#include <QWidget>
+
+#include <opencv2/core.hpp>
+
+// Renders the tracker-pt point model as blurred IR blobs moving along a
+// fixed trajectory, for measuring the extractor and pose solver without a
+// camera. The model-to-camera transform of every frame can be written to a
+// CSV file; it's the same quantity the PT tracker estimates as X_CM.
+
+namespace synthetic_camera_impl {
+
+using namespace video::impl;
+using namespace options;
+
+struct settings final
+{
+    bundle b = make_bundle("video-synthetic");
+    value<double> distance { b, "distance-mm", 600 };
+    value<double> yaw_amplitude { b, "yaw-amplitude", 30 };
+    value<double> pitch_amplitude { b, "pitch-amplitude", 15 };
+    value<double> period { b, "period-seconds", 8 };
+    value<double> led_radius { b, "led-radius-mm", 2.5 };
+    value<double> noise { b, "noise-stddev", 2 };
+    value<int> distractors { b, "distractor-count", 0 };
+    value<bool> paced { b, "paced", true };
+    value<QString> ground_truth { b, "ground-truth-file", {} };
+};
+
+struct metadata : camera_
+{
+    metadata();
+    std::vector<QString> camera_names() const override;
+    std::unique_ptr<camera> make_camera(const QString& name) override;
+    bool can_show_dialog(const QString& camera_name) override;
+    bool show_dialog(const QString& camera_name) override;
+};
+
+struct cam final : camera
+{
+    cam();
+    ~cam() override;
+
+    bool start(info& args) override;
+    void stop() override;
+    bool is_open() override;
+    std::tuple<const frame&, bool> get_frame() override;
+    bool show_dialog() override;
+
+private:
+    struct distractor final
+    {
+        float x, y, radius;
+    };
+
+    void render(const cv::Matx33d& R, const cv::Vec3d& t);
+    void write_ground_truth(const cv::Matx33d& R, const cv::Vec3d& t);
+
+    settings s;
+    pt_settings pt { "tracker-pt" };
+
+    cv::Mat1b gray;
+    cv::Mat1s noise;
+    cv::Mat3b color;
+    frame frame_;
+
+    cv::Vec3d model[3];
+    std::vector<distractor> distractors;
+    cv::RNG rng;
+    QFile ground_truth;
+    Timer t;
+
+    double fps = 30, focal_length = 1;
+    unsigned frame_no = 0;
+    bool open = false, luma = false, paced = true;
+};
+
+class dialog final : public QWidget
+{
+    Q_OBJECT
+    Ui_synthetic_dialog ui;
+    settings s;
+
+    void do_ok() { s.b->save(); close(); deleteLater(); }
+    void do_cancel() { s.b->reload(); close(); deleteLater(); }
+
+protected:
+    void closeEvent(QCloseEvent*) override { do_cancel(); }
+
+public:
+    explicit dialog(QWidget* parent = nullptr);
+};
+
+} // ns synthetic_camera_impl
@@ -0,0 +1,618 @@
+#include "impl.hpp"
+#include "compat/math.hpp"
+
+#include <algorithm>
+#include <cerrno>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <linux/videodev2.h>
+
+#include <opencv2/imgproc.hpp>
+#include <opencv2/imgcodecs.hpp>
+
+#include <QDebug>
+
+namespace v4l2_camera_impl {
+
+static constexpr int poll_timeout_ms = 1000;
+
+static int xioctl(int fd, unsigned long req, void* arg)
+{
+    int ret;
+    do
+        ret = ioctl(fd, req, arg);
+    while (ret == -1 && errno == EINTR);
+    return ret;
+}
+
+static unsigned to_fourcc(capture_format fmt)
+{
+    switch (fmt)
+    {
+    case fmt_yuyv: return V4L2_PIX_FMT_YUYV;
+    case fmt_mjpeg: return V4L2_PIX_FMT_MJPEG;
+    case fmt_grey: return V4L2_PIX_FMT_GREY;
+    case fmt_bgr24: return V4L2_PIX_FMT_BGR24;
+    case fmt_auto: break;
+    }
+    return 0;
+}
+
+static bool has_format(int fd, unsigned fourcc)
+{
+    v4l2_fmtdesc desc {};
+    desc.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+
+    for (desc.index = 0; xioctl(fd, VIDIOC_ENUM_FMT, &desc) == 0; desc.index++)
+        if (desc.pixelformat == fourcc)
+            return true;
+
+    return false;
+}
+
+cam::cam(const QString& path) : path(path)
+{
+}
+
+cam::~cam()
+{
+    stop();
+}
+
+bool cam::is_open()
+{
+    return streaming;
+}
+
+void cam::stop()
+{
+    if (fd != -1)
+    {
+        unmap_buffers();
+        close(fd);
+        fd = -1;
+    }
+
+    streaming = false;
+    held = -1;
+    fourcc = 0; width = 0; height = 0; bytesperline = 0;
+    bounds = {}; full = {}; crop = {};
+    full_width = 0; full_height = 0;
+    roi_x = 0; roi_y = 0; binning = 1;
+    prev_roi_x = 0; prev_roi_y = 0;
+    last_sequence = 0; roi_sequence = 0; roi_pending = false;
+    luma = false; can_crop = false;
+    mat = cv::Mat();
+    frame_ = {};
+}
+
+void cam::unmap_buffers()
+{
+    if (streaming)
+    {
+        int type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        (void)xioctl(fd, VIDIOC_STREAMOFF, &type);
+        streaming = false;
+    }
+
+    for (const buffer& b : buffers)
+        munmap(b.start, b.length);
+    buffers.clear();
+    held = -1;
+
+    v4l2_requestbuffers req {};
+    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+    (void)xioctl(fd, VIDIOC_REQBUFS, &req);
+}
+
+bool cam::stream_on()
+{
+    int type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if (xioctl(fd, VIDIOC_STREAMON, &type) == -1)
+    {
+        qDebug() << "v4l2: VIDIOC_STREAMON" << errno;
+        return false;
+    }
+
+    streaming = true;
+    // sequence numbers start over with the stream
+    last_sequence = 0;
+    roi_pending = false;
+    return true;
+}
+
+bool cam::start(info& args)
+{
+    stop();
+
+    luma = args.accept_luma;
+    fd = open(path.toLocal8Bit().constData(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+
+    if (fd == -1)
+    {
+        qDebug() << "v4l2: can't open" << path << errno;
+        return false;
+    }
+
+    reset_crop();
+
+    if (!set_format(args))
+        goto fail;
+
+    set_framerate(args);
+
+    if (!map_buffers() || !stream_on())
+        goto fail;
+
+    full_width = width;
+    full_height = height;
+    update_roi();
+
+    return true;
+
+fail:
+    stop();
+    return false;
+}
+
+bool cam::set_format(info& args)
+{
+    unsigned want = to_fourcc(*s.pixel_format);
+
+    if (want && !has_format(fd, want))
+    {
+        qDebug() << "v4l2: pixel format not supported by" << path;
+        return false;
+    }
+
+    // MJPEG goes last since it's the only one that needs a decoder
+    if (!want)
+    {
+        const unsigned color_formats[] = {
+            V4L2_PIX_FMT_BGR24, V4L2_PIX_FMT_YUYV, V4L2_PIX_FMT_GREY, V4L2_PIX_FMT_MJPEG,
+        };
+        const unsigned luma_formats[] = {
+            V4L2_PIX_FMT_GREY, V4L2_PIX_FMT_YUYV, V4L2_PIX_FMT_BGR24, V4L2_PIX_FMT_MJPEG,
+        };
+
+        for (unsigned x : luma ? luma_formats : color_formats)
+            if (has_format(fd, x))
+            {
+                want = x;
+                break;
+            }
+    }
+
+    if (!want)
+    {
+        qDebug() << "v4l2: no usable pixel format on" << path;
+        return false;
+    }
+
+    v4l2_format fmt {};
+    fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+
+    if (xioctl(fd, VIDIOC_G_FMT, &fmt) == -1)
+    {
+        qDebug() << "v4l2: VIDIOC_G_FMT" << errno;
+        return false;
+    }
+
+    fmt.fmt.pix.pixelformat = want;
+    fmt.fmt.pix.field = V4L2_FIELD_NONE;
+    if (args.width > 0 && args.height > 0)
+    {
+        fmt.fmt.pix.width = (unsigned)args.width;
+        fmt.fmt.pix.height = (unsigned)args.height;
+    }
+
+    // the driver picks the nearest size it supports
+    if (xioctl(fd, VIDIOC_S_FMT, &fmt) == -1 || fmt.fmt.pix.pixelformat != want)
+    {
+        qDebug() << "v4l2: VIDIOC_S_FMT" << errno;
+        return false;
+    }
+
+    fourcc = want;
+    width = fmt.fmt.pix.width;
+    height = fmt.fmt.pix.height;
+    bytesperline = fmt.fmt.pix.bytesperline;
+
+    args.width = (int)width;
+    args.height = (int)height;
+
+    return true;
+}
+
+// drivers keep the crop across opens, start from the full field of view
+void cam::reset_crop()
+{
+    v4l2_selection sel {};
+    sel.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    sel.target = V4L2_SEL_TGT_CROP_BOUNDS;
+
+    // UVC has no cropping at all
+    if (xioctl(fd, VIDIOC_G_SELECTION, &sel) == -1)
+        return;
+    bounds = sel.r;
+
+    sel.target = V4L2_SEL_TGT_CROP_DEFAULT;
+    if (xioctl(fd, VIDIOC_G_SELECTION, &sel) == -1)
+        return;
+    full = sel.r;
+
+    sel.target = V4L2_SEL_TGT_CROP;
+    if (xioctl(fd, VIDIOC_S_SELECTION, &sel) == -1)
+    {
+        qDebug() << "v4l2: VIDIOC_S_SELECTION" << errno;
+        return;
+    }
+
+    crop = sel.r;
+    can_crop = true;
+}
+
+bool cam::set_size(unsigned w, unsigned h)
+{
+    v4l2_format fmt {};
+    fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+
+    if (xioctl(fd, VIDIOC_G_FMT, &fmt) == -1)
+    {
+        qDebug() << "v4l2: VIDIOC_G_FMT" << errno;
+        return false;
+    }
+
+    fmt.fmt.pix.width = w;
+    fmt.fmt.pix.height = h;
+
+    if (xioctl(fd, VIDIOC_S_FMT, &fmt) == -1 || fmt.fmt.pix.pixelformat != fourcc)
+    {
+        qDebug() << "v4l2: VIDIOC_S_FMT" << errno;
+        return false;
+    }
+
+    width = fmt.fmt.pix.width;
+    height = fmt.fmt.pix.height;
+    bytesperline = fmt.fmt.pix.bytesperline;
+
+    return true;
+}
+
+// back from sensor pixels to the frame size start() reported
+void cam::update_roi()
+{
+    if (!can_crop || !full.width || !full.height || !full_width || !full_height)
+    {
+        roi_x = 0; roi_y = 0; binning = 1;
+        return;
+    }
+
+    const double sx = full.width / (double)full_width, sy = full.height / (double)full_height;
+
+    roi_x = iround((crop.left - full.left) / sx);
+    roi_y = iround((crop.top - full.top) / sy);
+    binning = std::max(1, iround(crop.width / sx / std::max(1u, width)));
+}
+
+bool cam::set_roi(const roi& r)
+{
+    if (!streaming || !can_crop)
+        return false;
+
+    const double sx = full.width / (double)full_width, sy = full.height / (double)full_height;
+
+    v4l2_rect rect = full;
+    unsigned w = full_width, h = full_height;
+
+    if (r.width > 0 && r.height > 0)
+    {
+        const int bin = std::clamp(r.binning, 1, 8);
+
+        rect.width = (unsigned)std::clamp(iround(r.width * sx), 1, (int)bounds.width);
+        rect.height = (unsigned)std::clamp(iround(r.height * sy), 1, (int)bounds.height);
+        rect.left = std::clamp(full.left + iround(r.x * sx), bounds.left, bounds.left + (int)(bounds.width - rect.width));
+        rect.top = std::clamp(full.top + iround(r.y * sy), bounds.top, bounds.top + (int)(bounds.height - rect.height));
+
+        w = (unsigned)std::max(1, r.width / bin);
+        h = (unsigned)std::max(1, r.height / bin);
+    }
+
+    v4l2_selection sel {};
+    sel.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    sel.target = V4L2_SEL_TGT_CROP;
+    sel.r = rect;
+
+    // only moving the window, some drivers take it without stopping the stream;
+    // frames already queued still carry the old position
+    if (rect.width == crop.width && rect.height == crop.height && w == width && h == height &&
+        xioctl(fd, VIDIOC_S_SELECTION, &sel) == 0 &&
+        sel.r.width == crop.width && sel.r.height == crop.height)
+    {
+        const unsigned queued = (unsigned)buffers.size() - (held != -1);
+
+        // if an earlier move hasn't reached the frames yet, they still carry the position before it
+        if (!roi_pending)
+        {
+            prev_roi_x = roi_x;
+            prev_roi_y = roi_y;
+        }
+        roi_sequence = last_sequence + queued + 1;
+        roi_pending = true;
+
+        crop = sel.r;
+        update_roi();
+        return true;
+    }
+
+    // anything else changes the buffer size
+    unmap_buffers();
+
+    sel.r = rect;
+    if (xioctl(fd, VIDIOC_S_SELECTION, &sel) == -1)
+        qDebug() << "v4l2: VIDIOC_S_SELECTION" << errno;
+
+    sel.target = V4L2_SEL_TGT_CROP;
+    if (xioctl(fd, VIDIOC_G_SELECTION, &sel) == 0)
+        crop = sel.r;
+
+    // the driver bins or scales down to this
+    if (!set_size(w, h) || !map_buffers() || !stream_on())
+    {
+        stop();
+        return false;
+    }
+
+    update_roi();
+    return true;
+}
+
+void cam::set_framerate(info& args)
+{
+    v4l2_streamparm parm {};
+    parm.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+
+    if (xioctl(fd, VIDIOC_G_PARM, &parm) == -1 ||
+        !(parm.parm.capture.capability & V4L2_CAP_TIMEPERFRAME))
+        return;
+
+    if (args.fps > 0)
+    {
+        parm.parm.capture.timeperframe = { 1, (unsigned)args.fps };
+        if (xioctl(fd, VIDIOC_S_PARM, &parm) == -1)
+            qDebug() << "v4l2: VIDIOC_S_PARM" << errno;
+    }
+
+    const v4l2_fract& tpf = parm.parm.capture.timeperframe;
+    if (tpf.numerator)
+        args.fps = iround(tpf.denominator / (double)tpf.numerator);
+}
+
+bool cam::map_buffers()
+{
+    v4l2_requestbuffers req {};
+    req.count = (unsigned)std::clamp(*s.buffer_count, min_buffers, max_buffers);
+    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+
+    if (xioctl(fd, VIDIOC_REQBUFS, &req) == -1 || req.count < (unsigned)min_buffers)
+    {
+        qDebug() << "v4l2: VIDIOC_REQBUFS" << errno << req.count;
+        return false;
+    }
+
+    buffers.reserve(req.count);
+
+    for (unsigned i = 0; i < req.count; i++)
+    {
+        v4l2_buffer buf {};
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index = i;
+
+        if (xioctl(fd, VIDIOC_QUERYBUF, &buf) == -1)
+        {
+            qDebug() << "v4l2: VIDIOC_QUERYBUF" << errno;
+            return false;
+        }
+
+        void* start = mmap(nullptr, buf.length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, buf.m.offset);
+
+        if (start == MAP_FAILED)
+        {
+            qDebug() << "v4l2: mmap" << errno;
+            return false;
+        }
+
+        buffers.push_back({ start, buf.length });
+
+        if (xioctl(fd, VIDIOC_QBUF, &buf) == -1)
+        {
+            qDebug() << "v4l2: VIDIOC_QBUF" << errno;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void cam::requeue(int idx)
+{
+    v4l2_buffer buf {};
+    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = V4L2_MEMORY_MMAP;
+    buf.index = (unsigned)idx;
+
+    if (xioctl(fd, VIDIOC_QBUF, &buf) == -1)
+        qDebug() << "v4l2: VIDIOC_QBUF" << errno;
+}
+
+// takes the newest filled buffer, older ones go straight back to the driver
+bool cam::dequeue(int& idx, unsigned& bytesused, std::uint64_t& timestamp_ns, unsigned& sequence)
+{
+    idx = -1;
+
+    for (;;)
+    {
+        v4l2_buffer buf {};
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+
+        if (xioctl(fd, VIDIOC_DQBUF, &buf) == -1)
+        {
+            // e.g. ENODEV once the camera is unplugged, close so is_open() tells the caller
+            if (errno != EAGAIN)
+            {
+                qDebug() << "v4l2: VIDIOC_DQBUF" << errno;
+                stop();
+                return false;
+            }
+
+            if (idx != -1)
+                return true;
+
+            pollfd pfd { fd, POLLIN, 0 };
+            int ret = poll(&pfd, 1, poll_timeout_ms);
+
+            if (ret == 0)
+                return false;
+
+            if ((ret == -1 && errno != EINTR) || (ret > 0 && (pfd.revents & (POLLERR | POLLHUP | POLLNVAL))))
+            {
+                qDebug() << "v4l2: poll" << (ret == -1 ? errno : (int)pfd.revents);
+                stop();
+                return false;
+            }
+
+            continue;
+        }
+
+        if (buf.flags & V4L2_BUF_FLAG_ERROR)
+        {
+            requeue((int)buf.index);
+            continue;
+        }
+
+        if (idx != -1)
+            requeue(idx);
+
+        idx = (int)buf.index;
+        bytesused = buf.bytesused;
+        sequence = buf.sequence;
+        // taken by the driver when capture started, on CLOCK_MONOTONIC for UVC
+        timestamp_ns = (std::uint64_t)buf.timestamp.tv_sec * 1000000000u + (std::uint64_t)buf.timestamp.tv_usec * 1000u;
+    }
+}
+
+bool cam::convert(int idx, unsigned bytesused, unsigned sequence)
+{
+    auto* data = (unsigned char*)buffers[(unsigned)idx].start;
+    const int w = (int)width, h = (int)height;
+
+    if (roi_pending && (int)(sequence - roi_sequence) >= 0)
+        roi_pending = false;
+
+    // moving the window doesn't change the binning
+    frame_.roi_x = roi_pending ? prev_roi_x : roi_x;
+    frame_.roi_y = roi_pending ? prev_roi_y : roi_y;
+    frame_.binning = binning;
+
+    switch (fourcc)
+    {
+    case V4L2_PIX_FMT_BGR24:
+        lend(idx, 3);
+        return true;
+    case V4L2_PIX_FMT_GREY:
+        if (luma)
+        {
+            lend(idx, 1);
+            return true;
+        }
+        cv::cvtColor(cv::Mat(h, w, CV_8UC1, data, bytesperline), mat, cv::COLOR_GRAY2BGR);
+        break;
+    case V4L2_PIX_FMT_YUYV:
+        if (luma)
+            cv::extractChannel(cv::Mat(h, w, CV_8UC2, data, bytesperline), mat, 0);
+        else
+            cv::cvtColor(cv::Mat(h, w, CV_8UC2, data, bytesperline), mat, cv::COLOR_YUV2BGR_YUYV);
+        break;
+    case V4L2_PIX_FMT_MJPEG:
+        // decode_luma() rejects truncated frames; imdecode() would pad them
+        // out with gray and pass them on, so don't fall back to it
+        if (luma && video::mjpeg_decoder::is_available())
+        {
+            const bool ok = mjpeg.decode_luma(data, bytesused, frame_);
+            requeue(idx);
+            return ok && frame_.width == w && frame_.height == h;
+        }
+        cv::imdecode(cv::Mat(1, (int)bytesused, CV_8UC1, data),
+                     luma ? cv::IMREAD_GRAYSCALE : cv::IMREAD_COLOR, &mat);
+        break;
+    default:
+        break;
+    }
+
+    requeue(idx);
+
+    const int channels = luma ? 1 : 3;
+
+    // corrupt jpeg data decodes to an empty image
+    if (mat.cols != w || mat.rows != h || mat.type() != CV_8UC(channels))
+        return false;
+
+    frame_.data = mat.data;
+    frame_.width = w;
+    frame_.height = h;
+    frame_.stride = 0;
+    frame_.channels = channels;
+
+    return true;
+}
+
+// hand out the driver's buffer as-is, it's requeued on the next get_frame()
+void cam::lend(int idx, int channels)
+{
+    held = idx;
+    frame_.data = (unsigned char*)buffers[(unsigned)idx].start;
+    frame_.width = (int)width;
+    frame_.height = (int)height;
+    frame_.stride = bytesperline == width * (unsigned)channels ? 0 : (int)bytesperline;
+    frame_.channels = channels;
+}
+
+std::tuple<const frame&, bool> cam::get_frame()
+{
+    if (!streaming)
+        return { frame_, false };
+
+    if (held != -1)
+    {
+        requeue(held);
+        held = -1;
+    }
+
+    int idx; unsigned bytesused = 0, sequence = 0;
+    std::uint64_t timestamp_ns = 0;
+
+    if (!dequeue(idx, bytesused, timestamp_ns, sequence))
+        return { frame_, false };
+
+    frame_.timestamp_ns = timestamp_ns;
+    last_sequence = sequence;
+
+    bool ret = convert(idx, bytesused, sequence);
+    return { frame_, ret };
+}
+
+bool cam::show_dialog()
+{
+    (new dialog)->show();
+    return true;
+}
+
+} // ns v4l2_camera_impl
@@ -0,0 +1,29 @@
+#include "impl.hpp"
+
+#include <iterator>
+
+namespace v4l2_camera_impl {
+
+dialog::dialog(QWidget* parent) : QWidget(parent)
+{
+    ui.setupUi(this);
+
+    constexpr capture_format formats[] = {
+        fmt_auto,
+        fmt_yuyv,
+        fmt_mjpeg,
+        fmt_grey,
+        fmt_bgr24,
+    };
+
+    for (unsigned k = 0; k < std::size(formats); k++)
+        ui.pixel_format->setItemData(k, int(formats[k]));
+
+    tie_setting(s.pixel_format, ui.pixel_format);
+    tie_setting(s.buffer_count, ui.buffer_count);
+
+    connect(ui.buttonBox, &QDialogButtonBox::accepted, this, &dialog::do_ok);
+    connect(ui.buttonBox, &QDialogButtonBox::rejected, this, &dialog::do_cancel);
+}
+
+} // ns v4l2_camera_impl
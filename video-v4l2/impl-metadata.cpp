@@ -0,0 +1,79 @@
+#include "impl.hpp"
+#include "compat/camera-names.hpp"
+
+#include <algorithm>
+
+namespace v4l2_camera_impl {
+
+std::vector<device> enum_devices()
+{
+    std::vector<device> ret;
+
+    // cached by compat and refreshed on hotplug, so this doesn't touch the devices
+    for (const camera_device& dev : get_camera_devices())
+    {
+        // UVC exposes a metadata node alongside each capture node
+        if (!dev.can_capture)
+            continue;
+
+        QString name = QStringLiteral("%1 (V4L2)").arg(dev.name);
+        const QString base = name;
+
+        for (int k = 2; std::any_of(ret.cbegin(), ret.cend(), [&](const device& d) { return d.name == name; }); k++)
+            name = QStringLiteral("%1 #%2").arg(base).arg(k);
+
+        ret.push_back({ name, QStringLiteral("/dev/video%1").arg(dev.index), dev.bus_path });
+    }
+
+    return ret;
+}
+
+metadata::metadata() = default;
+
+std::vector<QString> metadata::camera_names() const
+{
+    std::vector<QString> ret;
+    for (const device& d : enum_devices())
+        ret.push_back(d.name);
+    return ret;
+}
+
+std::unique_ptr<camera> metadata::make_camera(const QString& name)
+{
+    for (const device& d : enum_devices())
+        if (d.name == name)
+            return std::make_unique<cam>(d.path);
+
+    return nullptr;
+}
+
+bool metadata::can_show_dialog(const QString& camera_name)
+{
+    for (const device& d : enum_devices())
+        if (d.name == camera_name)
+            return true;
+
+    return false;
+}
+
+QString metadata::camera_id(const QString& camera_name) const
+{
+    for (const device& d : enum_devices())
+        if (d.name == camera_name && !d.bus_path.isEmpty())
+            return QStringLiteral("v4l2:%1").arg(d.bus_path);
+
+    return {};
+}
+
+bool metadata::show_dialog(const QString& camera_name)
+{
+    if (!can_show_dialog(camera_name))
+        return false;
+
+    (new dialog)->show();
+    return true;
+}
+
+OTR_REGISTER_CAMERA(metadata)
+
+} // ns v4l2_camera_impl
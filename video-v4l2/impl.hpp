@@ -0,0 +1,128 @@
+#pragma once
+
+#include "video/camera.hpp"
+#include "video/mjpeg.hpp"
+#include "options/options.hpp"
+#include "ui_dialog.h"
+
+#include <vector>
+
+#include <QWidget>
+
+#include <linux/videodev2.h>
+
+#include <opencv2/core.hpp>
+
+namespace v4l2_camera_impl {
+
+using namespace video::impl;
+using namespace options;
+
+enum capture_format : int
+{
+    fmt_auto    = 0,
+    fmt_yuyv    = 1,
+    fmt_mjpeg   = 2,
+    fmt_grey    = 3,
+    fmt_bgr24   = 4,
+};
+
+struct settings final
+{
+    bundle b = make_bundle("video-v4l2");
+    value<capture_format> pixel_format { b, "pixel-format", fmt_auto };
+    value<int> buffer_count { b, "buffer-count", 4 };
+};
+
+struct device final
+{
+    QString name, path, bus_path;
+};
+
+// capture nodes that can stream, with duplicate names numbered
+std::vector<device> enum_devices();
+
+struct metadata : camera_
+{
+    metadata();
+    std::vector<QString> camera_names() const override;
+    std::unique_ptr<camera> make_camera(const QString& name) override;
+    bool can_show_dialog(const QString& camera_name) override;
+    bool show_dialog(const QString& camera_name) override;
+    QString camera_id(const QString& camera_name) const override;
+};
+
+struct cam final : camera
+{
+    static constexpr int min_buffers = 2, max_buffers = 32;
+
+    explicit cam(const QString& path);
+    ~cam() override;
+
+    bool start(info& args) override;
+    void stop() override;
+    bool is_open() override;
+    std::tuple<const frame&, bool> get_frame() override;
+    bool show_dialog() override;
+    bool set_roi(const roi& r) override;
+
+private:
+    struct buffer final
+    {
+        void* start = nullptr;
+        size_t length = 0;
+    };
+
+    bool set_format(info& args);
+    void set_framerate(info& args);
+    void reset_crop();
+    bool set_size(unsigned w, unsigned h);
+    void update_roi();
+    bool map_buffers();
+    void unmap_buffers();
+    bool stream_on();
+    bool dequeue(int& idx, unsigned& bytesused, std::uint64_t& timestamp_ns, unsigned& sequence);
+    void requeue(int idx);
+    bool convert(int idx, unsigned bytesused, unsigned sequence);
+    void lend(int idx, int channels);
+
+    settings s;
+    QString path;
+    std::vector<buffer> buffers;
+    cv::Mat mat;
+    video::mjpeg_decoder mjpeg;
+    frame frame_;
+    int fd = -1;
+    // buffer lent out by the last get_frame(), stays dequeued until the next call
+    int held = -1;
+    unsigned fourcc = 0, width = 0, height = 0, bytesperline = 0;
+    // sensor rectangles, if the driver has a crop selection; `full' is the
+    // default crop, its size as captured at start() is the ROI coordinate space
+    v4l2_rect bounds {}, full {}, crop {};
+    unsigned full_width = 0, full_height = 0;
+    int roi_x = 0, roi_y = 0, binning = 1;
+    // a window moved while streaming applies from this buffer sequence number on,
+    // buffers queued before then still carry the old position
+    int prev_roi_x = 0, prev_roi_y = 0;
+    unsigned last_sequence = 0, roi_sequence = 0;
+    bool roi_pending = false;
+    bool streaming = false, luma = false, can_crop = false;
+};
+
+class dialog final : public QWidget
+{
+    Q_OBJECT
+    Ui_v4l2_dialog ui;
+    settings s;
+
+    void do_ok() { s.b->save(); close(); deleteLater(); }
+    void do_cancel() { s.b->reload(); close(); deleteLater(); }
+
+protected:
+    void closeEvent(QCloseEvent*) override { do_cancel(); }
+
+public:
+    explicit dialog(QWidget* parent = nullptr);
+};
+
+} // ns v4l2_camera_impl
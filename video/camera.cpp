@@ -1,4 +1,5 @@
 #include "camera.hpp"
+#include "recording.hpp"
 
 #include <algorithm>
 #include <utility>
@@ -15,6 +16,10 @@ camera_::~camera_() = default;
 camera::camera() = default;
 camera::~camera() = default;
 
+bool camera::set_roi(const roi&) { return false; }
+
+QString camera_::camera_id(const QString&) const { return {}; }
+
 void register_camera(std::unique_ptr<impl::camera_> camera)
 {
     QMutexLocker l(&mtx);
@@ -25,6 +30,16 @@ void register_camera(std::unique_ptr<impl::camera_> camera)
 
 namespace video {
 
+static std::unique_ptr<camera_impl> maybe_record(std::unique_ptr<camera_impl> camera)
+{
+    static const QString filename = QString::fromLocal8Bit(qgetenv("OTR_RECORD_VIDEO"));
+
+    if (camera && !filename.isEmpty())
+        return recording::make_recording_camera(std::move(camera), filename);
+    else
+        return camera;
+}
+
 bool show_dialog(const QString& camera_name)
 {
     QMutexLocker l(&mtx);
@@ -44,7 +59,7 @@ std::unique_ptr<camera_impl> make_camera_(const QString& name)
     for (auto& camera : metadata)
         for (const QString& name_ : camera->camera_names())
             if (name_ == name)
-                return camera->make_camera(name_);
+                return maybe_record(camera->make_camera(name_));
 
     return nullptr;
 }
@@ -57,7 +72,7 @@ std::unique_ptr<camera_impl> make_camera(const QString& name)
     for (auto& camera : metadata)
         for (const QString& name_ : camera->camera_names())
             if (auto ret = camera->make_camera(name_))
-                return ret;
+                return maybe_record(std::move(ret));
 
     return nullptr;
 }
@@ -76,4 +91,31 @@ std::vector<QString> camera_names()
     return names;
 }
 
+QString camera_id(const QString& camera_name)
+{
+    QMutexLocker l(&mtx);
+
+    for (auto& camera : metadata)
+        for (const QString& name : camera->camera_names())
+            if (name == camera_name)
+                return camera->camera_id(name);
+
+    return {};
+}
+
+QString resolve_camera_name(const QString& camera_name, const QString& camera_id)
+{
+    if (camera_id.isEmpty())
+        return camera_name;
+
+    QMutexLocker l(&mtx);
+
+    for (auto& camera : metadata)
+        for (const QString& name : camera->camera_names())
+            if (camera->camera_id(name) == camera_id)
+                return name;
+
+    return camera_name;
+}
+
 } // ns video
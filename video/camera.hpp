@@ -9,6 +9,7 @@
 
 #include "export.hpp"
 
+#include <cstdint>
 #include <memory>
 #include <vector>
 
@@ -23,6 +24,12 @@ struct frame final
     // the `stride' member can have a special value of zero,
     // signifying stride equal to width * element size
     int width = 0, height = 0, stride = 0, channels = 0, channel_size = 1;
+    // where the frame lies in the full field of view, for cameras cropping
+    // on the device; a frame pixel (x, y) is at (roi_x + x * binning, roi_y + y * binning)
+    int roi_x = 0, roi_y = 0, binning = 1;
+    // when the device captured the frame, in nanoseconds on a monotonic
+    // clock; zero if the backend can't tell
+    std::uint64_t timestamp_ns = 0;
 };
 
 } // ns video
@@ -42,6 +49,10 @@ struct OTR_VIDEO_EXPORT camera_
     virtual std::unique_ptr<camera> make_camera(const QString& name) = 0;
     virtual bool show_dialog(const QString& camera_name) = 0;
     virtual bool can_show_dialog(const QString& camera_name) = 0;
+
+    // survives reboots and renumbering, unlike the name; empty if the backend can't tell.
+    // Should be unique across backends, e.g. by prefixing the backend's name.
+    virtual QString camera_id(const QString& camera_name) const;
 };
 
 struct OTR_VIDEO_EXPORT camera
@@ -53,6 +64,15 @@ struct OTR_VIDEO_EXPORT camera
         double fx = 0, fy = 0;          // focal length
         double P_x = 0, P_y = 0;        // principal point
         double dist_c[8] {};            // distortion coefficients
+        // set by the caller if single-channel 8-bit frames will do;
+        // backends may then pass luma through without converting to BGR
+        bool accept_luma = false;
+    };
+
+    // in full field of view pixels, an empty rectangle means no cropping
+    struct roi final
+    {
+        int x = 0, y = 0, width = 0, height = 0, binning = 1;
     };
 
     camera();
@@ -64,6 +84,11 @@ struct OTR_VIDEO_EXPORT camera
 
     virtual std::tuple<const frame&, bool> get_frame() = 0;
     [[nodiscard]] virtual bool show_dialog() = 0;
+
+    // crop and bin on the device to cut down on bandwidth; the device may
+    // adjust the window, see frame::roi_x. The last frame returned becomes
+    // invalid. Returns false if the camera can't do it.
+    virtual bool set_roi(const roi& r);
 };
 
 OTR_VIDEO_EXPORT
@@ -91,6 +116,14 @@ OTR_VIDEO_EXPORT std::unique_ptr<camera_impl> make_camera_(const QString& name);
 OTR_VIDEO_EXPORT
 std::vector<QString> camera_names();
 
+// to be saved along with the camera name, see resolve_camera_name()
+OTR_VIDEO_EXPORT
+QString camera_id(const QString& camera_name);
+
+// current name of the camera with that id, or `camera_name' if no camera has it
+OTR_VIDEO_EXPORT
+QString resolve_camera_name(const QString& camera_name, const QString& camera_id);
+
 [[nodiscard]]
 OTR_VIDEO_EXPORT
 bool show_dialog(const QString& camera_name);
@@ -0,0 +1,134 @@
+#include "mjpeg.hpp"
+
+#include <algorithm>
+
+#ifdef OTR_VIDEO_HAVE_JPEG
+#   include <csetjmp>
+#   include <cstdio>
+#   include <jpeglib.h>
+#   include <jerror.h>
+#endif
+
+namespace video {
+
+#ifdef OTR_VIDEO_HAVE_JPEG
+
+struct mjpeg_decoder::impl final
+{
+    struct error_mgr final
+    {
+        jpeg_error_mgr pub;
+        std::jmp_buf jmp;
+        bool truncated;
+    };
+
+    jpeg_decompress_struct cinfo {};
+    error_mgr err {};
+
+    impl()
+    {
+        cinfo.err = jpeg_std_error(&err.pub);
+        // the default handler calls exit()
+        err.pub.error_exit = [](j_common_ptr c) {
+            std::longjmp(reinterpret_cast<error_mgr*>(c->err)->jmp, 1);
+        };
+        // some cameras pad every frame with junk, only reject truncated ones
+        err.pub.emit_message = [](j_common_ptr c, int level) {
+            if (level < 0 && c->err->msg_code == JWRN_JPEG_EOF)
+                reinterpret_cast<error_mgr*>(c->err)->truncated = true;
+        };
+        jpeg_create_decompress(&cinfo);
+    }
+
+    ~impl()
+    {
+        jpeg_destroy_decompress(&cinfo);
+    }
+};
+
+mjpeg_decoder::mjpeg_decoder() : p { std::make_unique<impl>() } {}
+mjpeg_decoder::~mjpeg_decoder() = default;
+
+bool mjpeg_decoder::is_available() { return true; }
+
+bool mjpeg_decoder::decode_luma(const unsigned char* data, std::size_t size, frame& out, unsigned scale)
+{
+    constexpr unsigned max_rows = 16;
+
+    if (scale != 1 && scale != 2 && scale != 4 && scale != 8)
+        return false;
+
+    jpeg_decompress_struct& cinfo = p->cinfo;
+    p->err.truncated = false;
+
+    // nothing with a destructor may live between here and the longjmp
+    if (setjmp(p->err.jmp))
+    {
+        jpeg_abort_decompress(&cinfo);
+        return false;
+    }
+
+    // UVC cameras leave out the Huffman tables, libjpeg-turbo fills in the standard ones
+    jpeg_mem_src(&cinfo, const_cast<unsigned char*>(data), (unsigned long)size);
+
+    if (jpeg_read_header(&cinfo, TRUE) != JPEG_HEADER_OK)
+    {
+        jpeg_abort_decompress(&cinfo);
+        return false;
+    }
+
+    cinfo.out_color_space = JCS_GRAYSCALE;
+    cinfo.scale_num = 1;
+    cinfo.scale_denom = scale;
+    cinfo.dct_method = JDCT_IFAST;
+    cinfo.do_block_smoothing = FALSE;
+
+    jpeg_start_decompress(&cinfo);
+
+    const unsigned w = cinfo.output_width, h = cinfo.output_height;
+    buf.resize((std::size_t)w * h);
+
+    while (cinfo.output_scanline < h)
+    {
+        JSAMPROW rows[max_rows];
+        const unsigned n = std::min(h - cinfo.output_scanline, max_rows);
+
+        for (unsigned k = 0; k < n; k++)
+            rows[k] = buf.data() + (std::size_t)(cinfo.output_scanline + k) * w;
+
+        jpeg_read_scanlines(&cinfo, rows, n);
+    }
+
+    jpeg_finish_decompress(&cinfo);
+
+    // libjpeg pads out truncated data instead of failing
+    if (p->err.truncated)
+        return false;
+
+    out.data = buf.data();
+    out.width = (int)w;
+    out.height = (int)h;
+    out.stride = 0;
+    out.channels = 1;
+    out.channel_size = 1;
+
+    return true;
+}
+
+#else
+
+struct mjpeg_decoder::impl final {};
+
+mjpeg_decoder::mjpeg_decoder() = default;
+mjpeg_decoder::~mjpeg_decoder() = default;
+
+bool mjpeg_decoder::is_available() { return false; }
+
+bool mjpeg_decoder::decode_luma(const unsigned char*, std::size_t, frame&, unsigned)
+{
+    return false;
+}
+
+#endif
+
+} // ns video
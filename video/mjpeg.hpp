@@ -0,0 +1,35 @@
+#pragma once
+
+#include "export.hpp"
+#include "camera.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace video {
+
+// Decodes only the Y component of MJPEG frames, skipping chroma IDCT and
+// color conversion entirely. Needs libjpeg at build time, otherwise
+// decode_luma() always fails and callers fall back to their own decoder.
+class OTR_VIDEO_EXPORT mjpeg_decoder final
+{
+    struct impl;
+    std::unique_ptr<impl> p;
+    std::vector<unsigned char> buf;
+
+public:
+    mjpeg_decoder();
+    ~mjpeg_decoder();
+
+    mjpeg_decoder(const mjpeg_decoder&) = delete;
+    mjpeg_decoder& operator=(const mjpeg_decoder&) = delete;
+
+    static bool is_available();
+
+    // `scale' of 2, 4 or 8 shrinks the image in the DCT domain at almost no cost.
+    // `out' points into the decoder and stays valid until the next call.
+    [[nodiscard]] bool decode_luma(const unsigned char* data, std::size_t size, frame& out, unsigned scale = 1);
+};
+
+} // ns video
@@ -0,0 +1,294 @@
+#include "recording.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include <QDebug>
+#include <QFileInfo>
+#include <QMutex>
+
+namespace video::recording {
+
+static constexpr std::uint64_t align = 8;
+
+static std::uint64_t padded(std::uint64_t x)
+{
+    return (x + align - 1) & ~(align - 1);
+}
+
+// bounded so that the product can't wrap, and a corrupt header can't
+// describe a frame larger than the record holding it
+static constexpr int max_dimension = 65535, max_channels = 4, max_channel_size = 2;
+
+static std::uint64_t data_size(const frame_header& hdr)
+{
+    if (hdr.width <= 0 || hdr.height <= 0 || hdr.channels <= 0 || hdr.channel_size <= 0)
+        return 0;
+    if (hdr.width > max_dimension || hdr.height > max_dimension ||
+        hdr.channels > max_channels || hdr.channel_size > max_channel_size)
+        return 0;
+    return (std::uint64_t)hdr.width * (unsigned)hdr.height * (unsigned)hdr.channels * (unsigned)hdr.channel_size;
+}
+
+// files currently mapped by a reader; truncating one would SIGBUS the
+// replay, e.g. with OTR_RECORD_VIDEO pointing at the file being replayed
+static QMutex replaying_mtx;
+static std::vector<QString> replaying;
+
+static QString canonical_path(const QString& filename)
+{
+    return QFileInfo(filename).canonicalFilePath();
+}
+
+static bool is_replaying(const QString& filename)
+{
+    const QString path = canonical_path(filename);
+    QMutexLocker l(&replaying_mtx);
+    return !path.isEmpty() && std::find(replaying.cbegin(), replaying.cend(), path) != replaying.cend();
+}
+
+bool writer::open(const QString& filename)
+{
+    close();
+
+    if (is_replaying(filename))
+    {
+        qDebug() << "video: not recording over" << filename << "while it's being replayed";
+        return false;
+    }
+
+    file.setFileName(filename);
+
+    if (!file.open(QFile::WriteOnly | QFile::Truncate))
+    {
+        qDebug() << "video: can't record to" << filename << file.errorString();
+        return false;
+    }
+
+    file_header hdr {};
+    std::memcpy(hdr.magic, magic, sizeof(magic));
+    hdr.version = version;
+
+    if (file.write((const char*)&hdr, sizeof(hdr)) != (qint64)sizeof(hdr))
+    {
+        close();
+        return false;
+    }
+
+    t.start();
+    first_timestamp_ns = 0;
+    return true;
+}
+
+void writer::close()
+{
+    if (file.isOpen())
+        file.close();
+}
+
+bool writer::write(const frame& fr)
+{
+    if (!file.isOpen() || !fr.data)
+        return false;
+
+    frame_header hdr {};
+    if (fr.timestamp_ns)
+    {
+        if (!first_timestamp_ns)
+            first_timestamp_ns = fr.timestamp_ns;
+        hdr.timestamp_ns = fr.timestamp_ns - first_timestamp_ns;
+    }
+    else
+        hdr.timestamp_ns = (std::uint64_t)(t.elapsed_ms() * 1e6);
+    hdr.width = fr.width;
+    hdr.height = fr.height;
+    hdr.channels = fr.channels;
+    hdr.channel_size = fr.channel_size;
+    hdr.roi_x = fr.roi_x;
+    hdr.roi_y = fr.roi_y;
+    hdr.binning = fr.binning;
+    hdr.size = data_size(hdr);
+
+    if (!hdr.size)
+        return false;
+
+    const qint64 row = (qint64)(hdr.size / (unsigned)fr.height);
+    const qint64 stride = fr.stride ? fr.stride : row;
+    static constexpr char zeros[align] {};
+    const qint64 pad = (qint64)(padded(hdr.size) - hdr.size);
+
+    bool ok = file.write((const char*)&hdr, sizeof(hdr)) == (qint64)sizeof(hdr);
+
+    if (stride == row)
+        ok &= file.write((const char*)fr.data, (qint64)hdr.size) == (qint64)hdr.size;
+    else
+        for (int y = 0; ok && y < fr.height; y++)
+            ok &= file.write((const char*)fr.data + y * stride, row) == row;
+
+    if (ok && pad)
+        ok &= file.write(zeros, pad) == pad;
+
+    if (!ok)
+    {
+        qDebug() << "video: recording stopped:" << file.errorString();
+        close();
+    }
+
+    return ok;
+}
+
+reader::~reader()
+{
+    close();
+}
+
+bool reader::open(const QString& filename)
+{
+    close();
+
+    file.setFileName(filename);
+
+    if (!file.open(QFile::ReadOnly))
+    {
+        qDebug() << "video: can't open recording" << filename << file.errorString();
+        return false;
+    }
+
+    const auto size = (std::uint64_t)file.size();
+
+    // private mapping, so a tracker scribbling on the frame can't corrupt the file
+    if (size >= sizeof(file_header))
+        base = file.map(0, (qint64)size, QFileDevice::MapPrivateOption);
+
+    file_header hdr {};
+    if (base)
+        std::memcpy(&hdr, base, sizeof(hdr));
+
+    if (!base || std::memcmp(hdr.magic, magic, sizeof(magic)) || hdr.version != version)
+    {
+        qDebug() << "video: not a recording" << filename;
+        close();
+        return false;
+    }
+
+    for (std::uint64_t pos = sizeof(file_header); pos + sizeof(frame_header) <= size; )
+    {
+        frame_header fhdr;
+        std::memcpy(&fhdr, base + pos, sizeof(fhdr));
+
+        // a recording cut short ends in a partial record
+        if (!fhdr.size || fhdr.size != data_size(fhdr) || pos + sizeof(frame_header) + fhdr.size > size)
+            break;
+
+        offsets.push_back(pos);
+        pos += sizeof(frame_header) + padded(fhdr.size);
+    }
+
+    if (offsets.empty())
+    {
+        qDebug() << "video: no frames in" << filename;
+        close();
+        return false;
+    }
+
+    path = canonical_path(filename);
+    {
+        QMutexLocker l(&replaying_mtx);
+        replaying.push_back(path);
+    }
+
+    return true;
+}
+
+void reader::close()
+{
+    if (!path.isEmpty())
+    {
+        QMutexLocker l(&replaying_mtx);
+        auto it = std::find(replaying.begin(), replaying.end(), path);
+        if (it != replaying.end())
+            replaying.erase(it);
+        path.clear();
+    }
+    if (base)
+        file.unmap(base);
+    base = nullptr;
+    offsets.clear();
+    if (file.isOpen())
+        file.close();
+}
+
+bool reader::get(unsigned idx, frame& fr, std::uint64_t& timestamp_ns) const
+{
+    if (idx >= offsets.size())
+        return false;
+
+    frame_header hdr;
+    std::memcpy(&hdr, base + offsets[idx], sizeof(hdr));
+
+    fr.data = base + offsets[idx] + sizeof(frame_header);
+    fr.width = hdr.width;
+    fr.height = hdr.height;
+    fr.stride = 0;
+    fr.channels = hdr.channels;
+    fr.channel_size = hdr.channel_size;
+    fr.roi_x = hdr.roi_x;
+    fr.roi_y = hdr.roi_y;
+    fr.binning = hdr.binning > 0 ? hdr.binning : 1;
+    timestamp_ns = hdr.timestamp_ns;
+
+    return true;
+}
+
+namespace {
+
+struct recording_camera final : impl::camera
+{
+    std::unique_ptr<impl::camera> cam;
+    QString filename;
+    writer w;
+
+    recording_camera(std::unique_ptr<impl::camera> cam, const QString& filename) :
+        cam(std::move(cam)), filename(filename)
+    {}
+
+    bool start(info& args) override
+    {
+        w.close();
+        if (!cam->start(args))
+            return false;
+        // tracking goes on even if the file can't be written
+        (void)w.open(filename);
+        return true;
+    }
+
+    void stop() override
+    {
+        cam->stop();
+        w.close();
+    }
+
+    bool is_open() override { return cam->is_open(); }
+
+    std::tuple<const frame&, bool> get_frame() override
+    {
+        auto [ fr, ok ] = cam->get_frame();
+        if (ok && w.is_open())
+            (void)w.write(fr);
+        return { fr, ok };
+    }
+
+    bool show_dialog() override { return cam->show_dialog(); }
+    bool set_roi(const roi& r) override { return cam->set_roi(r); }
+};
+
+} // ns
+
+std::unique_ptr<impl::camera> make_recording_camera(std::unique_ptr<impl::camera> cam, const QString& filename)
+{
+    if (!cam)
+        return nullptr;
+    return std::make_unique<recording_camera>(std::move(cam), filename);
+}
+
+} // ns video::recording
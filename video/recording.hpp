@@ -0,0 +1,75 @@
+#pragma once
+
+#include "export.hpp"
+#include "camera.hpp"
+#include "compat/timer.hpp"
+
+#include <cstdint>
+#include <vector>
+
+#include <QFile>
+
+// Raw frame dump for replaying camera footage without the hardware.
+// The file is a header followed by one record per frame; each record is
+// a frame_header and tightly packed rows padded to 8 bytes. Set
+// OTR_RECORD_VIDEO to a file name to record whatever camera a tracker opens.
+
+namespace video::recording {
+
+struct file_header final
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t reserved;
+};
+
+struct frame_header final
+{
+    // capture time relative to the first frame, see frame::timestamp_ns;
+    // for cameras that don't report one, when the frame reached the writer
+    std::uint64_t timestamp_ns;
+    std::int32_t width, height, channels, channel_size;
+    // see frame::roi_x, needed to map points back into the full field of view
+    std::int32_t roi_x, roi_y, binning, reserved;
+    std::uint64_t size; // pixel data only, not counting the padding
+};
+
+static_assert(sizeof(frame_header) == 48);
+
+static constexpr char magic[8] = { 'O', 'T', 'R', 'V', 'R', 'E', 'C', '\0' };
+static constexpr std::uint32_t version = 2;
+
+class OTR_VIDEO_EXPORT writer final
+{
+    QFile file;
+    Timer t;
+    std::uint64_t first_timestamp_ns = 0;
+
+public:
+    [[nodiscard]] bool open(const QString& filename);
+    void close();
+    bool is_open() const { return file.isOpen(); }
+    bool write(const frame& fr);
+};
+
+class OTR_VIDEO_EXPORT reader final
+{
+    QFile file;
+    QString path; // canonical, while mapped
+    unsigned char* base = nullptr;
+    std::vector<std::uint64_t> offsets;
+
+public:
+    ~reader();
+
+    [[nodiscard]] bool open(const QString& filename);
+    void close();
+    unsigned frame_count() const { return (unsigned)offsets.size(); }
+    // frame data points into the mapping and stays valid until close()
+    bool get(unsigned idx, frame& fr, std::uint64_t& timestamp_ns) const;
+};
+
+// wraps a camera, writing each frame it returns
+std::unique_ptr<impl::camera> make_recording_camera(std::unique_ptr<impl::camera> cam, const QString& filename);
+
+} // ns video::recording
@@ -29,25 +29,43 @@ void video_widget::update_image(const QImage& img)
 
     set_image(img.constBits(), img.width(), img.height(),
               img.bytesPerLine(), img.format());
-    set_fresh(true);
 }
 
-void video_widget::set_image(const unsigned char* src, int width, int height, int stride, QImage::Format fmt)
+unsigned char* video_widget::back_buffer(int width, int height, int stride, QImage::Format fmt)
+{
+    buffer& b = buffers[back];
+    const unsigned nbytes = (unsigned)(stride * height);
+
+    if (b.data.size() < nbytes)
+        b.data.resize(nbytes);
+
+    b.width = width; b.height = height; b.stride = stride; b.fmt = fmt;
+
+    return b.data.data();
+}
+
+void video_widget::swap_buffers()
 {
-    QMutexLocker l(&mtx);
+    back = middle.exchange(back | fresh_bit, std::memory_order_acq_rel) & ~fresh_bit;
+}
 
-    texture = QImage();
-    unsigned nbytes = (unsigned)(stride * height);
-    vec.resize(nbytes); vec.shrink_to_fit();
-    std::memcpy(vec.data(), src, nbytes);
-    texture = QImage((const unsigned char*)vec.data(), width, height, stride, fmt);
+void video_widget::set_image(const unsigned char* src, int width, int height, int stride, QImage::Format fmt)
+{
+    unsigned char* dst = back_buffer(width, height, stride, fmt);
+    std::memcpy(dst, src, (unsigned)(stride * height));
+    swap_buffers();
 }
 
 void video_widget::paintEvent(QPaintEvent*)
 {
-    QPainter painter(this);
+    if (fresh())
+    {
+        front = middle.exchange(front, std::memory_order_acq_rel) & ~fresh_bit;
+        const buffer& b = buffers[front];
+        texture = QImage((const unsigned char*)b.data.data(), b.width, b.height, b.stride, b.fmt);
+    }
 
-    QMutexLocker l(&mtx);
+    QPainter painter(this);
     painter.drawImage(rect(), texture);
 }
 
@@ -60,12 +78,10 @@ void video_widget::draw_image()
         return;
 
     repaint();
-    set_fresh(false);
 }
 
 void video_widget::resizeEvent(QResizeEvent*)
 {
-    QMutexLocker l(&mtx);
     init_image_nolock();
 }
 
@@ -77,11 +93,6 @@ std::tuple<int, int> video_widget::preview_size() const
 
 bool video_widget::fresh() const
 {
-    return fresh_.load(std::memory_order_acquire);
-}
-
-void video_widget::set_fresh(bool x)
-{
-    fresh_.store(x, std::memory_order_release);
+    return middle.load(std::memory_order_acquire) & fresh_bit;
 }
 
@@ -18,8 +18,10 @@
 #include <QImage>
 #include <QTimer>
 
-#include <QMutex>
-
+// Producers fill a back buffer and swap it with the middle one; painting
+// swaps the middle one with its front buffer. Nobody waits on anybody and
+// the buffers only grow when the image gets bigger. Only one thread may
+// produce images at a time.
 struct OTR_VIDEO_EXPORT video_widget : QWidget
 {
     video_widget(QWidget* parent = nullptr);
@@ -31,19 +33,31 @@ struct OTR_VIDEO_EXPORT video_widget : QWidget
     void draw_image();
 
 protected:
-    mutable QMutex mtx { QMutex::NonRecursive };
-    QImage texture;
-    std::vector<unsigned char> vec;
     bool fresh() const;
-    void set_fresh(bool x);
     void set_image(const unsigned char* src, int width, int height, int stride, QImage::Format fmt);
+    // fill the returned pointer, then call swap_buffers()
+    unsigned char* back_buffer(int width, int height, int stride, QImage::Format fmt);
+    void swap_buffers();
 
 private:
+    struct buffer final
+    {
+        std::vector<unsigned char> data;
+        int width = 0, height = 0, stride = 0;
+        QImage::Format fmt = QImage::Format_Invalid;
+    };
+
+    static constexpr unsigned fresh_bit = 1 << 2;
+
     void init_image_nolock();
     QTimer timer;
 
+    buffer buffers[3];
+    QImage texture;
+    unsigned back = 0, front = 1;
+    std::atomic<unsigned> middle { 2 };
+
     std::atomic<QSize> size_ = QSize(320, 240);
-    std::atomic<bool> fresh_ { false };
 
-    static_assert(decltype(fresh_)::is_always_lock_free);
+    static_assert(decltype(middle)::is_always_lock_free);
 };